@@ -8,19 +8,115 @@
 ******************************************************************/
 #include "ResourceManager.h"
 
+#include <condition_variable>
+#include <cstring>
 #include <iostream>
+#include <memory>
+#include <mutex>
 #include <sstream>
 #include <fstream>
 
+// stb_image allocates through the recycling image arena, decoding many images does not churn the heap
+#include "image_arena.h"
+#define STBI_MALLOC(size)          image_arena_malloc(size)
+#define STBI_REALLOC(block, size)  image_arena_realloc(block, size)
+#define STBI_FREE(block)           image_arena_free(block)
 #define STB_IMAGE_IMPLEMENTATION
 #include <glad/glad.h>
 
 #include "stb_image.h"
+#include "asset_cache.h"
+#include "asset_pack.h"
+#include "compressed_texture.h"
+#include "embedded_assets.h"
+#include "load_profiler.h"
+#include "mipmap.h"
+#include "pixel_buffer_pool.h"
+#include "thread_pool.h"
+
+// Restart intervals of large JPEGs are decoded on the worker pool
+static void decode_in_parallel(void*, int count, void (*task)(void*, int), void* data)
+{
+    ThreadPool::shared().parallel_for(static_cast<unsigned int>(count), [task, data](unsigned int index) { task(data, static_cast<int>(index)); });
+}
+static const bool parallel_decoding = (stbi_set_parallel_for(decode_in_parallel, nullptr), true);
 
 // Instantiate static variables
 std::map<std::string, Texture2D>    ResourceManager::texture_map;
 std::map<std::string, Shader>       ResourceManager::shader_map;
 
+// Streaming state. Decoded images wait for a free pixel buffer, a worker copies them into
+// the mapped buffer and the GL thread uploads from it on the next update_streaming()
+struct StreamedTexture
+{
+    TextureData  data;
+    PixelBuffer* buffer;
+};
+static PixelBufferPool*             stream_buffers = nullptr;
+static std::mutex                   stream_mutex;
+static std::vector<TextureData>     stream_decoded;      // decoded on a worker, waiting for a pixel buffer
+static std::vector<StreamedTexture> stream_filled;       // written into a pixel buffer, waiting for upload
+static std::vector<TextureData>     stream_waiting;      // GL thread only: no pixel buffer was free yet
+static unsigned int                 stream_jobs = 0;     // decode and copy jobs still running on the pool
+static std::condition_variable      stream_jobs_done;
+constexpr unsigned int              stream_buffer_count = 4;
+
+// Residency state (GL thread only)
+static std::map<std::string, TextureResidency> texture_residency;
+static std::map<unsigned int, std::string>     texture_names;          // texture id -> name, for touch_texture
+static std::size_t                             texture_budget = 0;     // bytes, 0 = unlimited
+static unsigned long long                      current_frame = 0;
+
+// Lazy loading state. Declared textures decoded on a worker, waiting for update_streaming to upload them
+static std::mutex                   lazy_mutex;
+static std::vector<TextureData>     lazy_decoded;
+
+// Preloaded textures, decoded ahead of their first use. Whoever claims an entry first decodes it:
+// the pool job started by preload_texture, or a load that asks for the file before that job ran
+struct PreloadedTexture
+{
+    bool                    alpha;
+    TextureSettings         settings;
+    std::mutex              mutex;
+    std::condition_variable ready_signal;
+    bool                    claimed = false;
+    bool                    ready = false;
+    TextureData             data;
+};
+static std::mutex                                              preload_mutex;
+static std::map<std::string, std::shared_ptr<PreloadedTexture>> preloaded;
+
+// client memory held by decoded image data
+static std::size_t staging_bytes(const TextureData& data)
+{
+    return (data.pixels != nullptr ? static_cast<std::size_t>(data.width) * data.height * data.channels : 0) + data.mip_chain.size();
+}
+
+// reads a whole binary file into buffer, reusing its capacity; returns false if the file cannot be read
+static bool read_source_file(const char* file, std::vector<unsigned char>& buffer)
+{
+    LoadTimer timer(file, stage_io);
+    buffer.clear();
+    std::ifstream sourceFile(file, std::ios::binary | std::ios::ate);
+    if (!sourceFile)
+        return false;
+    buffer.resize(static_cast<size_t>(sourceFile.tellg()));
+    sourceFile.seekg(0);
+    sourceFile.read(reinterpret_cast<char*>(buffer.data()), static_cast<std::streamsize>(buffer.size()));
+    timer.set_bytes(buffer.size());
+    return static_cast<bool>(sourceFile);
+}
+
+// gives a texture a single transparent (or black) texel to show while its image is loading
+static void generate_placeholder(Texture2D& texture, bool alpha)
+{
+    static const unsigned char texel[4] = { 0, 0, 0, 0 };
+    texture.internal_format = alpha ? GL_RGBA : GL_RGB;
+    texture.image_format = texture.internal_format;
+    texture.filter_min = GL_LINEAR;
+    texture.generate(1, 1, texel);
+}
+
 
 Shader ResourceManager::load_shader(const char* v_shader_file, const char* f_shader_file, const char* g_shader_file, std::string name)
 {
@@ -33,16 +129,336 @@ Shader ResourceManager::get_shader(std::string name)
     return shader_map[name];
 }
 
-Texture2D ResourceManager::load_texture(const char* file, bool alpha, std::string name)
+Texture2D ResourceManager::load_texture(const char* file, bool alpha, std::string name, const TextureSettings& settings)
 {
+    TextureData data = decode_texture_from_file(file, alpha, settings);
+    const std::size_t staging = staging_bytes(data);
     // Save the texture with the given name to the map
-    texture_map[name] = load_texture_from_file(file, alpha);
+    texture_map[name] = upload_texture(data);
+    track_texture(name, data, staging, texture_map[name]);
     return texture_map[name];
 }
 
+Texture2D ResourceManager::declare_texture(const char* file, bool alpha, std::string name, const TextureSettings& settings)
+{
+    Texture2D texture;
+    generate_placeholder(texture, alpha);
+    texture_map[name] = texture;
+    TextureResidency residency;
+    residency.file = file;
+    residency.alpha = alpha;
+    residency.settings = settings;
+    residency.staging_bytes = 0;
+    residency.gpu_bytes = 0;
+    residency.last_used_frame = current_frame;
+    residency.resident = false;
+    residency.lazy = true;
+    residency.loading = false;
+    texture_residency[name] = residency;
+    texture_names[texture.id] = name;
+    return texture;
+}
+
+void ResourceManager::prefetch_texture(std::string name)
+{
+    const auto residency = texture_residency.find(name);
+    if (residency == texture_residency.end() || !residency->second.lazy)
+    {
+        std::cout << "ERROR::TEXTURE: Cannot prefetch " << name << ", it was not declared" << std::endl;
+        return;
+    }
+    if (!residency->second.resident && !residency->second.loading)
+        load_in_background(name, residency->second);
+}
+
 Texture2D ResourceManager::get_texture(std::string name)
 {
-    return texture_map[name];
+    Texture2D& texture = texture_map[name];
+    touch_texture(texture.id);
+    return texture;
+}
+
+void ResourceManager::stream_texture(const char* file, bool alpha, std::string name)
+{
+    const std::string path = file;
+    {
+        std::lock_guard<std::mutex> lock(stream_mutex);
+        stream_jobs++;
+    }
+    ThreadPool::shared().submit([path, alpha, name]
+    {
+        TextureData data = decode_texture_from_file(path.c_str(), alpha);
+        data.name = name;
+        // block-compressed images cannot go through the pixel buffers
+        if (data.base_level() == nullptr || data.compressed_format != 0)
+            free_texture_data(data);
+        std::lock_guard<std::mutex> lock(stream_mutex);
+        if (data.base_level() != nullptr)
+            stream_decoded.push_back(data);
+        stream_jobs--;
+        stream_jobs_done.notify_all();
+    });
+}
+
+void ResourceManager::update_streaming()
+{
+    // upload declared textures whose images were decoded since the last frame
+    std::vector<TextureData> loaded;
+    {
+        std::lock_guard<std::mutex> lock(lazy_mutex);
+        loaded.swap(lazy_decoded);
+    }
+    for (TextureData& data : loaded)
+    {
+        const auto residency = texture_residency.find(data.name);
+        if (residency == texture_residency.end() || !residency->second.loading)
+        {
+            // cleared while it was loading
+            free_texture_data(data);
+            continue;
+        }
+        Texture2D& texture = texture_map[data.name];
+        // a file that failed to decode keeps its placeholder (the error was already reported)
+        if (data.base_level() != nullptr || data.compressed_format != 0)
+        {
+            residency->second.staging_bytes = staging_bytes(data);
+            upload_texture_into(data, texture);
+        }
+        else
+            free_texture_data(data);
+        residency->second.gpu_bytes = texture.memory_size();
+        residency->second.last_used_frame = current_frame;
+        residency->second.resident = true;
+        residency->second.loading = false;
+    }
+    if (!loaded.empty())
+        enforce_texture_budget();
+
+    std::vector<StreamedTexture> filled;
+    {
+        std::lock_guard<std::mutex> lock(stream_mutex);
+        stream_waiting.insert(stream_waiting.end(), stream_decoded.begin(), stream_decoded.end());
+        stream_decoded.clear();
+        filled.swap(stream_filled);
+    }
+
+    // upload everything the workers finished writing since the last frame
+    for (StreamedTexture& streamed : filled)
+    {
+        Texture2D& texture = texture_map[streamed.data.name];
+        const unsigned int format = streamed.data.alpha ? GL_RGBA : GL_RGB;
+        // a texture with mipmaps keeps them: they are rebuilt from the new level 0
+        const auto residency = texture_residency.find(streamed.data.name);
+        const bool mipmapped = texture.mip_levels > 1 || (residency != texture_residency.end() && residency->second.settings.mipmaps != mipmaps_none);
+        // (re)allocate storage only when the image no longer fits the existing texture (or it was evicted)
+        if (texture.width != static_cast<unsigned int>(streamed.data.width) || texture.height != static_cast<unsigned int>(streamed.data.height) ||
+            texture.image_format != format || texture.mip_levels == 0)
+        {
+            texture.internal_format = format;
+            texture.image_format = format;
+            texture.generate(streamed.data.width, streamed.data.height, nullptr);
+        }
+        stream_buffers->upload(streamed.buffer, texture);
+        if (mipmapped)
+            texture.generate_mipmaps();
+        if (residency != texture_residency.end())
+        {
+            residency->second.gpu_bytes = texture.memory_size();
+            residency->second.last_used_frame = current_frame;
+            residency->second.resident = true;
+        }
+    }
+
+    if (stream_waiting.empty())
+        return;
+    if (stream_buffers == nullptr)
+        stream_buffers = new PixelBufferPool(stream_buffer_count);
+
+    // hand mapped pixel buffers to the workers; images that find no free buffer wait for the next frame
+    for (auto iter = stream_waiting.begin(); iter != stream_waiting.end();)
+    {
+        const size_t size = static_cast<size_t>(iter->width) * iter->height * (iter->alpha ? 4 : 3);
+        if (static_cast<size_t>(iter->width) * iter->height * iter->channels != size)
+        {
+            std::cout << "ERROR::TEXTURE: " << iter->name << " has " << iter->channels << " channels, cannot stream it" << std::endl;
+            free_texture_data(*iter);
+            iter = stream_waiting.erase(iter);
+            continue;
+        }
+        PixelBuffer* buffer = stream_buffers->acquire(size);
+        if (buffer == nullptr)
+            break;
+        StreamedTexture streamed = { *iter, buffer };
+        {
+            std::lock_guard<std::mutex> lock(stream_mutex);
+            stream_jobs++;
+        }
+        ThreadPool::shared().submit([streamed, size]() mutable
+        {
+            std::memcpy(streamed.buffer->data, streamed.data.base_level(), size);
+            free_texture_data(streamed.data);
+            std::lock_guard<std::mutex> lock(stream_mutex);
+            stream_filled.push_back(streamed);
+            stream_jobs--;
+            stream_jobs_done.notify_all();
+        });
+        iter = stream_waiting.erase(iter);
+    }
+}
+
+void ResourceManager::set_texture_budget(std::size_t bytes)
+{
+    texture_budget = bytes;
+    enforce_texture_budget();
+}
+
+void ResourceManager::begin_frame()
+{
+    current_frame++;
+    enforce_texture_budget();
+}
+
+void ResourceManager::touch_texture(unsigned int id)
+{
+    const auto name = texture_names.find(id);
+    if (name == texture_names.end())
+        return;
+    TextureResidency& residency = texture_residency[name->second];
+    residency.last_used_frame = current_frame;
+    if (residency.resident || residency.loading)
+        return;
+    // declared textures load in the background and show their placeholder meanwhile
+    if (residency.lazy)
+    {
+        load_in_background(name->second, residency);
+        return;
+    }
+    // transparent reload into the same texture object, so copies held by game objects stay valid
+    TextureData data = decode_texture_from_file(residency.file.c_str(), residency.alpha, residency.settings);
+    Texture2D& texture = texture_map[name->second];
+    upload_texture_into(data, texture);
+    residency.gpu_bytes = texture.memory_size();
+    residency.resident = true;
+}
+
+std::size_t ResourceManager::texture_memory_usage()
+{
+    std::size_t usage = 0;
+    for (const auto& iter : texture_residency)
+        usage += iter.second.resident ? iter.second.gpu_bytes : 0;
+    return usage;
+}
+
+void ResourceManager::print_texture_residency()
+{
+    std::cout << "Texture residency (frame " << current_frame << ", " << texture_memory_usage() / 1024 << " KiB resident";
+    if (texture_budget > 0)
+        std::cout << " of " << texture_budget / 1024 << " KiB budget";
+    std::cout << ")" << std::endl;
+    for (const auto& iter : texture_residency)
+    {
+        const char* state = iter.second.resident ? "resident" : iter.second.loading ? "loading" : iter.second.gpu_bytes > 0 ? "evicted" : "not loaded";
+        std::cout << "  " << iter.first << ": " << state << ", GPU " << iter.second.gpu_bytes / 1024
+            << " KiB, staging " << iter.second.staging_bytes / 1024 << " KiB, last used frame " << iter.second.last_used_frame << std::endl;
+    }
+}
+
+void ResourceManager::track_texture(const std::string& name, const TextureData& data, std::size_t staging_bytes, const Texture2D& texture)
+{
+    TextureResidency residency;
+    residency.file = data.file;
+    residency.alpha = data.alpha;
+    residency.settings = data.settings;
+    residency.staging_bytes = staging_bytes;
+    residency.gpu_bytes = texture.memory_size();
+    residency.last_used_frame = current_frame;
+    residency.resident = true;
+    residency.lazy = false;
+    residency.loading = false;
+    texture_residency[name] = residency;
+    texture_names[texture.id] = name;
+    enforce_texture_budget();
+}
+
+void ResourceManager::enforce_texture_budget()
+{
+    if (texture_budget == 0)
+        return;
+    std::size_t usage = texture_memory_usage();
+    while (usage > texture_budget)
+    {
+        // least recently used texture that was not drawn in the current or the previous frame
+        std::map<std::string, TextureResidency>::iterator victim = texture_residency.end();
+        for (auto iter = texture_residency.begin(); iter != texture_residency.end(); ++iter)
+        {
+            if (iter->second.resident && iter->second.last_used_frame + 1 < current_frame
+                && (victim == texture_residency.end() || iter->second.last_used_frame < victim->second.last_used_frame))
+                victim = iter;
+        }
+        if (victim == texture_residency.end())
+            return; // everything left is in use, the budget is simply too small
+        texture_map[victim->first].release_storage();
+        victim->second.resident = false;
+        usage -= victim->second.gpu_bytes;
+    }
+}
+
+void ResourceManager::load_in_background(const std::string& name, TextureResidency& residency)
+{
+    // an evicted texture has no storage left, it shows the placeholder again until the upload
+    Texture2D& texture = texture_map[name];
+    if (texture.mip_levels == 0)
+        generate_placeholder(texture, residency.alpha);
+    residency.loading = true;
+    const std::string file = residency.file;
+    const bool alpha = residency.alpha;
+    const TextureSettings settings = residency.settings;
+    ThreadPool::shared().submit([name, file, alpha, settings]
+    {
+        TextureData data = decode_texture_from_file(file.c_str(), alpha, settings);
+        data.name = name;
+        std::lock_guard<std::mutex> lock(lazy_mutex);
+        lazy_decoded.push_back(std::move(data));
+    });
+}
+
+bool ResourceManager::load_pack(const char* file)
+{
+    AssetPack pack;
+    const EmbeddedAsset* embedded = find_embedded_asset(file);
+    if (embedded != nullptr ? !pack.open_memory(embedded->data, embedded->size, file) : !pack.open(file))
+        return false;
+    // shaders and textures are created straight from the mapped file, no decoding or copies involved
+    for (unsigned int i = 0; i < pack.entry_count(); i++)
+    {
+        const PackEntry& entry = pack.entry(i);
+        const char* payload = reinterpret_cast<const char*>(pack.payload(entry));
+        if (entry.type == pack_shader)
+        {
+            const char* vertex = payload;
+            const char* fragment = vertex + entry.stage_size[0] + 1;
+            const char* geometry = fragment + entry.stage_size[1] + 1;
+            Shader shader;
+            LoadTimer timer(std::string(file) + ":" + entry.name, stage_upload, static_cast<size_t>(entry.size));
+            shader.compile(vertex, fragment, entry.stage_size[2] > 0 ? geometry : nullptr);
+            shader_map[entry.name] = shader;
+        }
+        else if (entry.type == pack_texture)
+        {
+            Texture2D texture;
+            if (entry.channels == 4)
+            {
+                texture.internal_format = GL_RGBA;
+                texture.image_format = GL_RGBA;
+            }
+            if (entry.mip_levels > 1)
+                texture.filter_min = GL_LINEAR_MIPMAP_LINEAR;
+            LoadTimer timer(std::string(file) + ":" + entry.name, stage_upload, static_cast<size_t>(entry.size));
+            texture.generate(entry.width, entry.height, reinterpret_cast<const unsigned char*>(payload), entry.mip_levels);
+            texture_map[entry.name] = texture;
+        }
+    }
+    return true;
 }
 
 void ResourceManager::clear()
@@ -53,67 +469,294 @@ void ResourceManager::clear()
     // (properly) delete all textures
     for (auto iter : texture_map)
         glDeleteTextures(1, &iter.second.id);
+    // and the streaming pixel buffers, once no worker writes into them anymore
+    {
+        std::unique_lock<std::mutex> lock(stream_mutex);
+        stream_jobs_done.wait(lock, [] { return stream_jobs == 0; });
+        for (StreamedTexture& streamed : stream_filled)
+            stream_buffers->release(streamed.buffer);
+        stream_filled.clear();
+        for (TextureData& data : stream_decoded)
+            free_texture_data(data);
+        stream_decoded.clear();
+    }
+    for (TextureData& data : stream_waiting)
+        free_texture_data(data);
+    stream_waiting.clear();
+    delete stream_buffers;
+    stream_buffers = nullptr;
+    texture_residency.clear();
+    texture_names.clear();
+    // and images of declared textures nobody will upload anymore
+    {
+        std::lock_guard<std::mutex> lock(lazy_mutex);
+        for (TextureData& data : lazy_decoded)
+            free_texture_data(data);
+        lazy_decoded.clear();
+    }
+    // and preloads nobody asked for
+    {
+        std::lock_guard<std::mutex> lock(preload_mutex);
+        for (auto& iter : preloaded)
+        {
+            std::unique_lock<std::mutex> preload_lock(iter.second->mutex);
+            if (iter.second->claimed)
+            {
+                iter.second->ready_signal.wait(preload_lock, [&iter] { return iter.second->ready; });
+                free_texture_data(iter.second->data);
+            }
+            iter.second->claimed = true;
+        }
+        preloaded.clear();
+    }
+    // cached decoder memory of this thread
+    image_arena_trim();
 }
 
 Shader ResourceManager::load_shader_from_file(const char* v_shader_file, const char* f_shader_file, const char* g_shader_file)
 {
     // 1. retrieve the vertex/fragment source code from filePath
-    std::string vertexCode;
-    std::string fragmentCode;
-    std::string geometryCode;
-    try
+    std::string vertexCode, fragmentCode, geometryCode;
     {
-        // open files
-        std::ifstream vertexShaderFile(v_shader_file);
-        std::ifstream fragmentShaderFile(f_shader_file);
-        std::stringstream vShaderStream, fShaderStream;
-        // read file's buffer contents into streams
-        vShaderStream << vertexShaderFile.rdbuf();
-        fShaderStream << fragmentShaderFile.rdbuf();
-        // close file handlers
-        vertexShaderFile.close();
-        fragmentShaderFile.close();
-        // convert stream into string
-        vertexCode = vShaderStream.str();
-        fragmentCode = fShaderStream.str();
+        LoadTimer readTimer(v_shader_file, stage_io);
+        vertexCode = read_text_file(v_shader_file);
+        fragmentCode = read_text_file(f_shader_file);
         // if geometry Shader path is present, also load a geometry Shader
         if (g_shader_file != nullptr)
-        {
-            std::ifstream geometryShaderFile(g_shader_file);
-            std::stringstream gShaderStream;
-            gShaderStream << geometryShaderFile.rdbuf();
-            geometryShaderFile.close();
-            geometryCode = gShaderStream.str();
-        }
-    }
-    catch (std::exception e)
-    {
-        std::cout << "ERROR::SHADER: Failed to read Shader files" << std::endl;
+            geometryCode = read_text_file(g_shader_file);
+        readTimer.set_bytes(vertexCode.size() + fragmentCode.size() + geometryCode.size());
     }
     const char* vShaderCode = vertexCode.c_str();
     const char* fShaderCode = fragmentCode.c_str();
     const char* gShaderCode = geometryCode.c_str();
     // 2. now create Shader object from source code
     Shader shader;
-    shader.compile(vShaderCode, fShaderCode, g_shader_file != nullptr ? gShaderCode : nullptr);
+    {
+        LoadTimer compileTimer(v_shader_file, stage_upload);
+        shader.compile(vShaderCode, fShaderCode, g_shader_file != nullptr ? gShaderCode : nullptr);
+    }
     return shader;
 }
 
-Texture2D ResourceManager::load_texture_from_file(const char* file, bool alpha)
+std::string ResourceManager::read_text_file(const char* file)
+{
+    if (const EmbeddedAsset* embedded = find_embedded_asset(file))
+        return std::string(reinterpret_cast<const char*>(embedded->data), embedded->size);
+    std::string code;
+    try
+    {
+        // open file and read its buffer contents into a stream
+        std::ifstream textFile(file);
+        std::stringstream textStream;
+        textStream << textFile.rdbuf();
+        textFile.close();
+        // convert stream into string
+        code = textStream.str();
+    }
+    catch (const std::exception& e)
+    {
+        std::cout << "ERROR::SHADER: Failed to read Shader file " << file << std::endl;
+    }
+    return code;
+}
+
+Texture2D ResourceManager::load_texture_from_file(const char* file, bool alpha, const TextureSettings& settings)
+{
+    TextureData data = decode_texture_from_file(file, alpha, settings);
+    return upload_texture(data);
+}
+
+void ResourceManager::preload_texture(const char* file, bool alpha, const TextureSettings& settings)
+{
+    std::shared_ptr<PreloadedTexture> preload = std::make_shared<PreloadedTexture>();
+    preload->alpha = alpha;
+    preload->settings = settings;
+    {
+        std::lock_guard<std::mutex> lock(preload_mutex);
+        if (!preloaded.emplace(file, preload).second)
+            return;
+    }
+    const std::string path = file;
+    ThreadPool::shared().submit([preload, path]
+    {
+        {
+            std::lock_guard<std::mutex> lock(preload->mutex);
+            if (preload->claimed)
+                return;
+            preload->claimed = true;
+        }
+        TextureData data = decode_texture(path.c_str(), preload->alpha, preload->settings);
+        std::lock_guard<std::mutex> lock(preload->mutex);
+        preload->data = std::move(data);
+        preload->ready = true;
+        preload->ready_signal.notify_all();
+    });
+}
+
+unsigned int ResourceManager::pending_texture_loads()
+{
+    unsigned int pending = 0;
+    for (const auto& iter : texture_residency)
+        pending += iter.second.loading ? 1 : 0;
+    return pending;
+}
+
+TextureData ResourceManager::decode_texture_from_file(const char* file, bool alpha, const TextureSettings& settings)
+{
+    std::shared_ptr<PreloadedTexture> preload;
+    {
+        std::lock_guard<std::mutex> lock(preload_mutex);
+        const auto iter = preloaded.find(file);
+        if (iter != preloaded.end())
+        {
+            preload = iter->second;
+            preloaded.erase(iter);
+        }
+    }
+    if (preload != nullptr)
+    {
+        std::unique_lock<std::mutex> lock(preload->mutex);
+        // not started yet: decode it right here, the pool job will find it claimed
+        if (!preload->claimed)
+            preload->claimed = true;
+        else
+        {
+            preload->ready_signal.wait(lock, [&preload] { return preload->ready; });
+            const TextureSettings& preloaded_settings = preload->settings;
+            if (preload->alpha == alpha && preloaded_settings.mipmaps == settings.mipmaps && preloaded_settings.smooth == settings.smooth && preloaded_settings.anisotropy == settings.anisotropy)
+                return std::move(preload->data);
+            // preloaded with other settings
+            free_texture_data(preload->data);
+        }
+    }
+    return decode_texture(file, alpha, settings);
+}
+
+TextureData ResourceManager::decode_texture(const char* file, bool alpha, const TextureSettings& settings)
+{
+    TextureData data;
+    data.name = file;
+    data.file = file;
+    data.alpha = alpha;
+    data.settings = settings;
+    data.compressed_format = 0;
+    data.mip_levels = 1;
+    data.pixels = nullptr;
+    // block-compressed containers are uploaded as they are
+    if (is_compressed_texture_file(file))
+    {
+        CompressedImage image;
+        data.width = data.height = data.channels = 0;
+        LoadTimer timer(file, stage_io);
+        if (load_compressed_texture(file, image))
+        {
+            data.width = image.width;
+            data.height = image.height;
+            data.channels = data.alpha ? 4 : 3;
+            data.compressed_format = image.format;
+            data.mip_levels = image.mip_levels;
+            data.mip_chain = std::move(image.data);
+            timer.set_bytes(data.mip_chain.size());
+        }
+        return data;
+    }
+    // files compiled into the executable are decoded in place and stay clear of the disk cache
+    const EmbeddedAsset* embedded = find_embedded_asset(file);
+    const bool cached = embedded == nullptr;
+    const unsigned char* source_data = cached ? nullptr : embedded->data;
+    std::size_t source_size = cached ? 0 : embedded->size;
+    std::uint64_t cache_key = 0;
+    if (cached)
+    {
+        // read the source file; its content decides whether the derived data cache can be used.
+        // the buffer is kept per thread, so bulk loads reuse it
+        static thread_local std::vector<unsigned char> source;
+        read_source_file(file, source);
+        source_data = source.data();
+        source_size = source.size();
+        cache_key = AssetCache::texture_key(source, settings);
+        LoadTimer timer(file, stage_io);
+        if (!source.empty() && AssetCache::load_texture(cache_key, data))
+        {
+            timer.set_bytes(data.mip_chain.size());
+            return data;
+        }
+    }
+    // load image
+    {
+        LoadTimer timer(file, stage_decode);
+        data.pixels = stbi_load_from_memory(source_data, static_cast<int>(source_size), &data.width, &data.height, &data.channels, 0);
+        timer.set_bytes(static_cast<size_t>(data.width) * data.height * data.channels);
+    }
+    if (data.pixels == nullptr)
+    {
+        std::cout << "ERROR::TEXTURE: Failed to load image " << file << ": " << stbi_failure_reason() << std::endl;
+        data.width = data.height = data.channels = 0;
+        return data;
+    }
+    // build the mip chain here so the filtering cost stays off the GL thread
+    if (settings.mipmaps == mipmaps_box || settings.mipmaps == mipmaps_kaiser)
+    {
+        LoadTimer timer(file, stage_convert);
+        data.mip_chain = build_mip_chain(data.pixels, data.width, data.height, data.channels, settings.mipmaps == mipmaps_kaiser ? mip_filter_kaiser : mip_filter_box);
+        data.mip_levels = mip_level_count(data.width, data.height);
+        stbi_image_free(data.pixels);
+        data.pixels = nullptr;
+        timer.set_bytes(data.mip_chain.size());
+    }
+    // remember the result, the next run skips decoding this asset
+    LoadTimer timer(file, stage_convert);
+    if (cached)
+        AssetCache::store_texture(cache_key, data);
+    return data;
+}
+
+Texture2D ResourceManager::upload_texture(TextureData& data)
 {
     // create texture object
     Texture2D texture;
-    if (alpha)
+    upload_texture_into(data, texture);
+    return texture;
+}
+
+void ResourceManager::upload_texture_into(TextureData& data, Texture2D& texture)
+{
+    LoadTimer timer(data.file, stage_upload);
+    if (data.alpha)
     {
         texture.internal_format = GL_RGBA;
         texture.image_format = GL_RGBA;
     }
-    // load image
-    int width, height, nrChannels;
-    unsigned char* data = stbi_load(file, &width, &height, &nrChannels, 0);
+    // configure sampling
+    const bool mipmapped = data.compressed_format != 0 ? data.mip_levels > 1 : data.settings.mipmaps != mipmaps_none;
+    if (mipmapped)
+        texture.filter_min = data.settings.smooth ? GL_LINEAR_MIPMAP_LINEAR : GL_NEAREST_MIPMAP_NEAREST;
+    else
+        texture.filter_min = data.settings.smooth ? GL_LINEAR : GL_NEAREST;
+    texture.filter_max = data.settings.smooth ? GL_LINEAR : GL_NEAREST;
+    texture.anisotropy = data.settings.anisotropy;
     // now generate texture
-    texture.generate(width, height, data);
+    if (data.compressed_format != 0)
+    {
+        if (Texture2D::supports_compressed_format(data.compressed_format))
+            texture.generate_compressed(data.width, data.height, data.compressed_format, data.mip_chain.data(), data.mip_levels);
+        else
+            std::cout << "ERROR::TEXTURE: Compressed format 0x" << std::hex << data.compressed_format << std::dec << " of " << data.name << " is not supported by this GPU" << std::endl;
+    }
+    else if (!data.mip_chain.empty())
+        texture.generate(data.width, data.height, data.mip_chain.data(), data.mip_levels);
+    else
+        texture.generate(data.width, data.height, data.pixels);
+    if (data.compressed_format == 0 && data.settings.mipmaps == mipmaps_gpu)
+        texture.generate_mipmaps();
+    timer.set_bytes(texture.memory_size());
     // and finally free image data
-    stbi_image_free(data);
-    return texture;
+    free_texture_data(data);
+}
+
+void ResourceManager::free_texture_data(TextureData& data)
+{
+    stbi_image_free(data.pixels);
+    data.pixels = nullptr;
+    std::vector<unsigned char>().swap(data.mip_chain);
 }
\ No newline at end of file
@@ -11,11 +11,43 @@
 
 #include <map>
 #include <string>
+#include <vector>
 
 #include "texture.h"
 #include "Shader.h"
 
 
+// Decoded image data held in client memory, waiting to be uploaded to the GPU
+struct TextureData
+{
+    std::string                name;
+    std::string                file;
+    bool                       alpha;
+    TextureSettings            settings;
+    int                        width, height, channels;
+    unsigned char*             pixels;    // level 0 as decoded, nullptr once a CPU mip chain replaced it
+    std::vector<unsigned char> mip_chain; // all levels, tightly packed, when mipmaps are built on the CPU or the file is block-compressed
+    unsigned int               compressed_format; // GL block-compression format of mip_chain, 0 for plain pixels
+    unsigned int               mip_levels;        // number of levels in mip_chain
+
+    // level 0 of an uncompressed image, wherever it is held (nullptr if decoding failed)
+    const unsigned char* base_level() const { return pixels != nullptr ? pixels : (mip_chain.empty() ? nullptr : mip_chain.data()); }
+};
+
+// Residency bookkeeping for a texture loaded from a file
+struct TextureResidency
+{
+    std::string        file;              // source, used to reload the texture after eviction
+    bool               alpha;
+    TextureSettings    settings;
+    std::size_t        staging_bytes;     // client memory needed to decode/convert it (freed after upload)
+    std::size_t        gpu_bytes;         // estimated GPU memory while resident
+    unsigned long long last_used_frame;
+    bool               resident;
+    bool               lazy;              // declared with declare_texture: (re)loaded in the background on use
+    bool               loading;           // a background load is in flight, the texture shows its placeholder
+};
+
 // A static singleton ResourceManager class that hosts several
 // functions to load texture_map and shader_map. Each loaded texture
 // and/or Shader is also stored for future reference by string
@@ -31,10 +63,46 @@ public:
     static Shader    load_shader(const char* v_shader_file, const char* f_shader_file, const char* g_shader_file, std::string name);
     // retrieves a stored Shader
     static Shader    get_shader(std::string name);
-    // loads (and generates) a texture from file
-    static Texture2D load_texture(const char* file, bool alpha, std::string name);
-    // retrieves a stored texture
+    // loads (and generates) a texture from file, with optional mipmaps, filtering and anisotropy settings.
+    // .dds and .ktx2 files are uploaded block-compressed as stored (their own mip chain replaces settings.mipmaps)
+    static Texture2D load_texture(const char* file, bool alpha, std::string name, const TextureSettings& settings = TextureSettings());
+    // registers a texture without reading its file. It shows a 1x1 placeholder until its first use (get_texture or
+    // drawing it) or a prefetch_texture hint has loaded it in the background; the id stays the same throughout
+    static Texture2D declare_texture(const char* file, bool alpha, std::string name, const TextureSettings& settings = TextureSettings());
+    // starts loading a declared texture ahead of its first use, e.g. for the next scene
+    static void      prefetch_texture(std::string name);
+    // retrieves a stored texture (starts loading it if it was only declared)
     static Texture2D get_texture(std::string name);
+    // (re)loads a texture in the background without blocking the frame: the image is decoded and written into a
+    // pixel buffer object on the worker pool, then uploaded from there. The named texture keeps its id, so copies
+    // already handed out show the new image once it has arrived
+    static void      stream_texture(const char* file, bool alpha, std::string name);
+    // advances streamed uploads and uploads declared textures that finished loading; call once per frame on the GL thread
+    static void      update_streaming();
+    // sets the GPU memory budget for textures loaded from files (0 = unlimited). When it is exceeded, textures
+    // that were not used in the last frame are evicted least recently used first and reloaded on their next use
+    static void      set_texture_budget(std::size_t bytes);
+    // starts a new frame: advances the frame counter used for LRU stamps and enforces the texture budget
+    static void      begin_frame();
+    // marks a texture as used in the current frame, reloading it first if it was evicted (the id stays the same)
+    static void      touch_texture(unsigned int id);
+    // estimated GPU memory of all resident textures, in bytes
+    static std::size_t texture_memory_usage();
+    // prints size, residency and last use of every tracked texture
+    static void      print_texture_residency();
+    // loads every shader and texture stored in an asset pack (see asset_pack.h); returns false if the pack cannot be opened
+    static bool      load_pack(const char* file);
+    // starts decoding an image file on the worker pool before it is needed. Makes no GL calls, so it can run before the window
+    // and GL context exist; the next decode of the same file (by any load function) picks up the result instead of decoding again
+    static void      preload_texture(const char* file, bool alpha, const TextureSettings& settings = TextureSettings());
+    // number of declared textures whose background load has not been uploaded yet
+    static unsigned int pending_texture_loads();
+    // decodes an image file into client memory and builds CPU mipmaps if requested; makes no GL calls, so it is safe to run on worker threads
+    static TextureData decode_texture_from_file(const char* file, bool alpha, const TextureSettings& settings = TextureSettings());
+    // releases the client memory of decoded image data
+    static void      free_texture_data(TextureData& data);
+    // reads a whole text file (e.g. Shader source code)
+    static std::string read_text_file(const char* file);
     // properly de-allocates all loaded resources
     static void      clear();
 private:
@@ -43,7 +111,19 @@ private:
     // loads and generates a Shader from file
     static Shader    load_shader_from_file(const char* v_shader_file, const char* f_shader_file, const char* g_shader_file = nullptr);
     // loads a single texture from file
-    static Texture2D load_texture_from_file(const char* file, bool alpha);
+    static Texture2D load_texture_from_file(const char* file, bool alpha, const TextureSettings& settings);
+    // does the actual work of decode_texture_from_file, ignoring preloads
+    static TextureData decode_texture(const char* file, bool alpha, const TextureSettings& settings);
+    // uploads decoded image data into a new texture and releases the client memory
+    static Texture2D upload_texture(TextureData& data);
+    // uploads decoded image data into an existing texture object and releases the client memory
+    static void      upload_texture_into(TextureData& data, Texture2D& texture);
+    // starts residency accounting for a texture that was just loaded from data
+    static void      track_texture(const std::string& name, const TextureData& data, std::size_t staging_bytes, const Texture2D& texture);
+    // frees the storage of least recently used textures until the budget is met
+    static void      enforce_texture_budget();
+    // decodes a declared texture on the worker pool; update_streaming uploads it
+    static void      load_in_background(const std::string& name, TextureResidency& residency);
 };
 
 #endif
\ No newline at end of file
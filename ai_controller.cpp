@@ -0,0 +1,102 @@
+#include "ai_controller.h"
+
+#include <algorithm>
+#include <cmath>
+
+float fold_reflections(const float y, const float low, const float high)
+{
+    const float span = high - low;
+    if (span <= 0.0f)
+        return low;
+    float offset = std::fmod(y - low, 2.0f * span);
+    if (offset < 0.0f)
+        offset += 2.0f * span;
+    return low + (offset <= span ? offset : 2.0f * span - offset);
+}
+
+float predict_crossing(const glm::vec2 position, const glm::vec2 velocity, const float plane_x, const float low, const float high)
+{
+    if (velocity.x == 0.0f)
+        return fold_reflections(position.y, low, high);
+    const float time = (plane_x - position.x) / velocity.x;
+    return fold_reflections(position.y + velocity.y * time, low, high);
+}
+
+AiSettings ai_settings(float skill)
+{
+    skill = std::min(std::max(skill, 0.0f), 1.0f);
+    AiSettings settings;
+    settings.reaction_delay = 0.5f * (1.0f - skill);
+    settings.error = 100.0f * (1.0f - skill);
+    settings.launch_delay = 0.2f + 0.6f * (1.0f - skill);
+    return settings;
+}
+
+AiController::AiController(const unsigned int player, const AiSettings& settings, const unsigned int seed)
+    : settings(settings), player_(player == 1 ? 1 : 2), seed_(seed), look_timer_(0.0f), hold_timer_(0.0f), target_(0.0f), aim_error_(0.0f),
+      ball_coming_(false)
+{
+
+}
+
+unsigned int AiController::player() const
+{
+    return this->player_;
+}
+
+void AiController::control(const Simulation& simulation, const float dt, SimulationInput& input)
+{
+    const GameObject& paddle = this->player_ == 1 ? simulation.player1 : simulation.player2;
+    bool& up = this->player_ == 1 ? input.player1_up : input.player2_up;
+    bool& down = this->player_ == 1 ? input.player1_down : input.player2_down;
+
+    this->look_timer_ -= dt;
+    if (this->look_timer_ <= 0.0f)
+    {
+        this->look(simulation);
+        this->look_timer_ = this->settings.reaction_delay;
+    }
+
+    // serve once the ball was held long enough
+    const bool holding = simulation.ball.stuck && (this->player_ == 1) == (simulation.ball.position.x <= simulation.width / 2);
+    this->hold_timer_ = holding ? this->hold_timer_ + dt : 0.0f;
+    if (holding && this->hold_timer_ >= this->settings.launch_delay)
+        input.launch = true;
+
+    // within one step of movement of the target counts as there, so it does not jitter around it
+    const float center = paddle.position.y + paddle.size.y / 2.0f;
+    const float tolerance = std::max(player_velocity * dt, 1.0f);
+    up = center > this->target_ + tolerance;
+    down = center < this->target_ - tolerance;
+}
+
+float AiController::random()
+{
+    this->seed_ = this->seed_ * 1664525u + 1013904223u;
+    return static_cast<float>(this->seed_ >> 8) / 16777216.0f;
+}
+
+void AiController::look(const Simulation& simulation)
+{
+    const BallObject& ball = simulation.ball;
+    const GameObject& paddle = this->player_ == 1 ? simulation.player1 : simulation.player2;
+    const float half_paddle = paddle.size.y / 2.0f;
+    const bool coming = !ball.stuck && (this->player_ == 1 ? ball.velocity.x < 0.0f : ball.velocity.x > 0.0f);
+
+    if (coming)
+    {
+        // a new aim error for every shot towards this paddle, not for every look
+        // (bell shaped: three uniform draws, scaled to a standard deviation of settings.error)
+        if (!this->ball_coming_)
+            this->aim_error_ = (this->random() + this->random() + this->random() - 1.5f) * 2.0f * this->settings.error;
+        const float plane_x = this->player_ == 1 ? paddle.position.x + paddle.size.x : paddle.position.x - ball.size.x;
+        const float crossing = predict_crossing(ball.position, ball.velocity, plane_x, 0.0f, simulation.height - ball.size.y);
+        this->target_ = crossing + ball.radius + this->aim_error_;
+    }
+    else if (ball.stuck)
+        this->target_ = ball.position.y + ball.radius; // stay with the ball
+    else
+        this->target_ = simulation.height / 2.0f; // wait in the middle for the return
+    this->ball_coming_ = coming;
+    this->target_ = std::min(std::max(this->target_, half_paddle), simulation.height - half_paddle);
+}
\ No newline at end of file
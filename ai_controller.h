@@ -0,0 +1,53 @@
+#ifndef AI_CONTROLLER_H
+#define AI_CONTROLLER_H
+
+#include "simulation.h"
+
+// Folds a coordinate that moved freely past low/high back into [low, high] the way wall bounces
+// would have: the unfolded path repeats every 2 * (high - low), so one fmod replaces every bounce.
+float fold_reflections(float y, float low, float high);
+
+// y of a ball (top left corner, like BallObject) when its x reaches plane_x, moving in a straight line
+// and bouncing between low and high; only meaningful if the ball moves towards the plane.
+float predict_crossing(glm::vec2 position, glm::vec2 velocity, float plane_x, float low, float high);
+
+// How well a computer player plays
+struct AiSettings
+{
+    float reaction_delay = 0.1f; // seconds between two looks at the ball; it acts on the last one meanwhile
+    float error          = 0.0f; // typical aim error in pixels (standard deviation), drawn again for every shot towards it
+    float launch_delay   = 0.5f; // seconds it holds the ball before serving
+};
+
+// settings for a skill from 0 (slow to react, misses often) to 1 (instant and exact)
+AiSettings ai_settings(float skill);
+
+// Computer opponent for one paddle. Rather than stepping the simulation ahead, it predicts in closed form
+// where the ball will cross its paddle (predict_crossing) and moves there, so a decision costs a few
+// multiplies and one fmod: cheap enough to drive thousands of bot matches per core.
+class AiController
+{
+public:
+    // player is 1 or 2; seed makes the aim errors repeatable
+    AiController(unsigned int player = 2, const AiSettings& settings = AiSettings(), unsigned int seed = 1);
+
+    AiSettings settings;
+
+    unsigned int player() const;
+    // sets the input of its paddle (and launch when it holds the ball) for the coming step of dt
+    void control(const Simulation& simulation, float dt, SimulationInput& input);
+private:
+    unsigned int player_;
+    unsigned int seed_;
+    float        look_timer_;   // time until the next look at the ball
+    float        hold_timer_;   // time the ball has been held
+    float        target_;       // paddle center it heads for
+    float        aim_error_;
+    bool         ball_coming_;  // the ball moved towards this paddle at the last look
+
+    float random();
+    // looks at the ball and picks a new target
+    void  look(const Simulation& simulation);
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,83 @@
+#include "arena.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+Arena::Arena(const unsigned int width, const unsigned int height)
+    : width(width), height(height)
+{
+
+}
+
+Entity Arena::add_ball(const glm::vec2 position, const glm::vec2 velocity, const float radius)
+{
+    const Entity ball = this->entities.create(component_transform | component_velocity | component_collider | component_sprite);
+    const std::size_t slot = this->entities.slot(ball);
+    this->entities.transform[slot] = { position, glm::vec2(radius * 2.0f), position };
+    this->entities.velocity[slot] = { velocity };
+    this->entities.collider[slot] = { collider_circle, radius };
+    this->entities.sprite[slot] = { arena_texture_ball, glm::vec3(1.0f) };
+    return ball;
+}
+
+Entity Arena::add_obstacle(const glm::vec2 position, const glm::vec2 size)
+{
+    const Entity obstacle = this->entities.create(component_transform | component_collider | component_sprite);
+    const std::size_t slot = this->entities.slot(obstacle);
+    this->entities.transform[slot] = { position + size * 0.5f, size, position + size * 0.5f };
+    this->entities.collider[slot] = { collider_box, 0.0f };
+    this->entities.sprite[slot] = { arena_texture_obstacle, glm::vec3(1.0f) };
+    return obstacle;
+}
+
+void Arena::populate(const unsigned int count, const float radius, unsigned int seed)
+{
+    this->entities.clear();
+    this->entities.reserve(count + 5);
+
+    // a paddle-like bar on each side and a row of blocks across the middle
+    const float w = static_cast<float>(this->width), h = static_cast<float>(this->height);
+    std::vector<glm::vec4> obstacles; // x, y, width, height
+    obstacles.push_back(glm::vec4(w * 0.05f, h * 0.35f, w * 0.015f, h * 0.3f));
+    obstacles.push_back(glm::vec4(w * 0.935f, h * 0.35f, w * 0.015f, h * 0.3f));
+    for (int i = 0; i < 3; i++)
+        obstacles.push_back(glm::vec4(w * (0.3f + 0.17f * i), h * 0.47f, w * 0.06f, h * 0.06f));
+    for (const glm::vec4& box : obstacles)
+        this->add_obstacle(glm::vec2(box.x, box.y), glm::vec2(box.z, box.w));
+
+    const auto random = [&seed]() {
+        seed = seed * 1664525u + 1013904223u;
+        return static_cast<float>(seed >> 8) / 16777216.0f;
+    };
+    for (unsigned int i = 0; i < count; i++)
+    {
+        // try a few spots clear of the obstacles; overlapping balls push each other apart in the first steps
+        glm::vec2 position;
+        for (int attempt = 0; attempt < 8; attempt++)
+        {
+            position = glm::vec2(radius + random() * (w - 2.0f * radius), radius + random() * (h - 2.0f * radius));
+            const bool blocked = std::any_of(obstacles.begin(), obstacles.end(), [&](const glm::vec4& box) {
+                const glm::vec2 difference = position - glm::clamp(position, glm::vec2(box.x, box.y), glm::vec2(box.x + box.z, box.y + box.w));
+                return glm::dot(difference, difference) < radius * radius;
+            });
+            if (!blocked)
+                break;
+        }
+        const float angle = random() * 6.2831853f;
+        const float speed = 100.0f + random() * 400.0f;
+        this->add_ball(position, glm::vec2(std::cos(angle), std::sin(angle)) * speed, radius);
+    }
+}
+
+std::size_t Arena::count() const
+{
+    return this->entities.size();
+}
+
+void Arena::step(const float dt)
+{
+    const glm::vec2 bounds(static_cast<float>(this->width), static_cast<float>(this->height));
+    movement_system(this->entities, dt, bounds);
+    this->collisions.update(this->entities, bounds);
+}
\ No newline at end of file
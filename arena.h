@@ -0,0 +1,43 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <cstddef>
+
+#include "entity_store.h"
+#include "entity_systems.h"
+
+// sprite textures of the arena entities, the game maps them to its textures
+enum arena_texture : unsigned int {
+    arena_texture_ball,
+    arena_texture_obstacle,
+    arena_texture_count
+};
+
+// Arena mode: any number of balls bouncing off each other, the obstacles and the walls; no paddles
+// or score. Balls are entities with a transform, velocity, circle collider and sprite, obstacles the
+// same without velocity and with a box collider. A step is the movement system followed by the
+// collision system, whose grid keeps a step about the same cost per ball at 100 or 100000 balls.
+class Arena
+{
+public:
+    // arena size
+    unsigned int    width, height;
+    EntityStore     entities;
+    CollisionSystem collisions;
+
+    // constructor
+    Arena(unsigned int width, unsigned int height);
+
+    // position is the ball center
+    Entity      add_ball(glm::vec2 position, glm::vec2 velocity, float radius);
+    // position is the top left corner
+    Entity      add_obstacle(glm::vec2 position, glm::vec2 size);
+    // empties the arena, then adds a few obstacles and count balls of the given radius at seeded random places and speeds
+    void        populate(unsigned int count, float radius, unsigned int seed = 1);
+    // number of entities, balls and obstacles
+    std::size_t count() const;
+    // moves every ball through dt and resolves the contacts
+    void        step(float dt);
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,166 @@
+#include "asset_cache.h"
+#include "mipmap.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <thread>
+
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+// Cache entry layout: CacheHeader followed by data_size bytes of pixel data (all mip levels, tightly packed)
+struct CacheHeader
+{
+    char          magic[4];
+    std::uint32_t version;
+    std::uint32_t width, height, channels, mip_levels;
+    std::uint64_t data_size;
+};
+static_assert(sizeof(CacheHeader) == 32, "CacheHeader must match the on-disk layout");
+
+constexpr char          cache_magic[4] = { 'P', 'T', 'X', 'C' };
+// bump whenever the import code changes its output (decoder, mip filters, ...) to invalidate old entries
+constexpr std::uint32_t cache_version = 1;
+
+std::string AssetCache::directory_ = "cache";
+
+
+std::uint64_t hash_bytes(const void* data, std::size_t size, std::uint64_t seed)
+{
+    // 8 bytes per step, multiply-xorshift mixing (same finalizer as MurmurHash3's fmix64)
+    constexpr std::uint64_t multiplier = 0x9E3779B97F4A7C15ull;
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    std::uint64_t hash = seed ^ (size * multiplier);
+    std::size_t i = 0;
+    for (; i + 8 <= size; i += 8)
+    {
+        std::uint64_t word;
+        std::memcpy(&word, bytes + i, sizeof(word));
+        word *= 0xFF51AFD7ED558CCDull;
+        word ^= word >> 32;
+        hash = (hash ^ word) * multiplier;
+        hash ^= hash >> 29;
+    }
+    std::uint64_t tail = 0;
+    for (std::size_t shift = 0; i < size; i++, shift += 8)
+        tail |= static_cast<std::uint64_t>(bytes[i]) << shift;
+    hash = (hash ^ tail) * multiplier;
+    hash ^= hash >> 33;
+    hash *= 0xFF51AFD7ED558CCDull;
+    hash ^= hash >> 33;
+    hash *= 0xC4CEB9FE1A85EC53ull;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+void AssetCache::set_directory(const std::string& directory)
+{
+    directory_ = directory;
+}
+
+const std::string& AssetCache::directory()
+{
+    return directory_;
+}
+
+std::uint64_t AssetCache::texture_key(const std::vector<unsigned char>& source, const TextureSettings& settings)
+{
+    // only settings that change the stored pixels take part: GPU mipmaps, filtering and anisotropy are applied at upload
+    const std::uint32_t import_settings[2] = {
+        cache_version,
+        static_cast<std::uint32_t>(settings.mipmaps == mipmaps_box || settings.mipmaps == mipmaps_kaiser ? settings.mipmaps : mipmaps_none)
+    };
+    return hash_bytes(source.data(), source.size(), hash_bytes(import_settings, sizeof(import_settings)));
+}
+
+std::string AssetCache::entry_path(std::uint64_t key)
+{
+    char name[24];
+    std::snprintf(name, sizeof(name), "%016llx.tex", static_cast<unsigned long long>(key));
+    return directory_ + "/" + name;
+}
+
+// bytes of pixel data an entry with this header must hold, 0 if the header cannot describe an image
+static std::uint64_t expected_data_size(const CacheHeader& header)
+{
+    if (header.width == 0 || header.height == 0 || header.channels == 0 || header.channels > 4 || header.mip_levels == 0 ||
+        header.mip_levels > mip_level_count(header.width, header.height))
+        return 0;
+    std::uint64_t size = 0;
+    unsigned int width = header.width, height = header.height;
+    for (unsigned int level = 0; level < header.mip_levels; level++)
+    {
+        size += static_cast<std::uint64_t>(width) * height * header.channels;
+        width = width > 1 ? width / 2 : 1;
+        height = height > 1 ? height / 2 : 1;
+    }
+    return size;
+}
+
+bool AssetCache::load_texture(std::uint64_t key, TextureData& data)
+{
+    if (directory_.empty())
+        return false;
+    std::ifstream in(entry_path(key), std::ios::binary);
+    CacheHeader header;
+    if (!in.read(reinterpret_cast<char*>(&header), sizeof(header)) || std::memcmp(header.magic, cache_magic, sizeof(cache_magic)) != 0 || header.version != cache_version)
+        return false;
+    // a corrupt or stale entry is a miss, it must not drive the allocation or the upload
+    if (header.data_size == 0 || header.data_size != expected_data_size(header))
+        return false;
+    // the pixel data goes straight into its final buffer with one read
+    data.mip_chain.resize(static_cast<std::size_t>(header.data_size));
+    if (!in.read(reinterpret_cast<char*>(data.mip_chain.data()), static_cast<std::streamsize>(header.data_size)))
+    {
+        std::vector<unsigned char>().swap(data.mip_chain);
+        return false;
+    }
+    data.width = header.width;
+    data.height = header.height;
+    data.channels = header.channels;
+    data.mip_levels = header.mip_levels;
+    return true;
+}
+
+void AssetCache::store_texture(std::uint64_t key, const TextureData& data)
+{
+    if (directory_.empty())
+        return;
+#ifdef _WIN32
+    _mkdir(directory_.c_str());
+#else
+    mkdir(directory_.c_str(), 0755);
+#endif
+    CacheHeader header = {};
+    std::memcpy(header.magic, cache_magic, sizeof(cache_magic));
+    header.version = cache_version;
+    header.width = data.width;
+    header.height = data.height;
+    header.channels = data.channels;
+    header.mip_levels = data.mip_levels;
+    const unsigned char* pixels = data.mip_chain.empty() ? data.pixels : data.mip_chain.data();
+    header.data_size = data.mip_chain.empty() ? static_cast<std::uint64_t>(data.width) * data.height * data.channels : data.mip_chain.size();
+
+    // write to a temporary file and rename it, so a concurrent reader never sees a partial entry
+    const std::string path = entry_path(key);
+    const std::string temporary = path + "." + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) + ".tmp";
+    {
+        std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(pixels), static_cast<std::streamsize>(header.data_size));
+        if (!out)
+        {
+            out.close();
+            std::remove(temporary.c_str());
+            return;
+        }
+    }
+    std::remove(path.c_str());
+    if (std::rename(temporary.c_str(), path.c_str()) != 0)
+        std::remove(temporary.c_str());
+}
\ No newline at end of file
@@ -0,0 +1,38 @@
+#ifndef ASSET_CACHE_H
+#define ASSET_CACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "ResourceManager.h"
+
+// 64 bit non-cryptographic hash of a byte range (fast enough to hash source images on every load)
+std::uint64_t hash_bytes(const void* data, std::size_t size, std::uint64_t seed = 0);
+
+
+// A static on-disk cache of derived texture data: the decoded, converted and
+// mipmapped result of importing a source image. Entries are keyed by a content
+// hash of the source file plus every import setting that changes the output, so
+// only changed assets are re-processed and stale entries are never hit.
+class AssetCache
+{
+public:
+    // directory holding the cache entries (created on demand); an empty string disables the cache
+    static void               set_directory(const std::string& directory);
+    static const std::string& directory();
+    // cache key of a source image imported with the given settings
+    static std::uint64_t      texture_key(const std::vector<unsigned char>& source, const TextureSettings& settings);
+    // fills data (dimensions, channels, mip_chain, mip_levels) from the cache; returns false on a miss
+    static bool               load_texture(std::uint64_t key, TextureData& data);
+    // stores the derived data of a freshly imported texture (pixels or mip_chain)
+    static void               store_texture(std::uint64_t key, const TextureData& data);
+private:
+    AssetCache() = default;
+    static std::string directory_;
+    // path of the entry for a key
+    static std::string entry_path(std::uint64_t key);
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,245 @@
+#include "asset_pack.h"
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+
+AssetPack::AssetPack()
+    : data_(nullptr), size_(0), file_handle_(nullptr), mapping_handle_(nullptr), mapped_(false) { }
+
+AssetPack::~AssetPack()
+{
+    this->close();
+}
+
+bool AssetPack::open(const char* file)
+{
+    this->close();
+#ifdef _WIN32
+    HANDLE handle = CreateFileA(file, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (handle == INVALID_HANDLE_VALUE)
+        return false;
+    LARGE_INTEGER file_size;
+    GetFileSizeEx(handle, &file_size);
+    HANDLE mapping = CreateFileMappingA(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    const void* view = mapping != nullptr ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+    if (view == nullptr)
+    {
+        if (mapping != nullptr)
+            CloseHandle(mapping);
+        CloseHandle(handle);
+        return false;
+    }
+    this->file_handle_ = handle;
+    this->mapping_handle_ = mapping;
+    this->data_ = static_cast<const unsigned char*>(view);
+    this->size_ = static_cast<std::size_t>(file_size.QuadPart);
+#else
+    const int fd = ::open(file, O_RDONLY);
+    if (fd < 0)
+        return false;
+    struct stat file_stat;
+    void* view = fstat(fd, &file_stat) == 0 && file_stat.st_size > 0
+        ? mmap(nullptr, static_cast<std::size_t>(file_stat.st_size), PROT_READ, MAP_PRIVATE, fd, 0)
+        : MAP_FAILED;
+    ::close(fd);
+    if (view == MAP_FAILED)
+        return false;
+    this->data_ = static_cast<const unsigned char*>(view);
+    this->size_ = static_cast<std::size_t>(file_stat.st_size);
+#endif
+    this->mapped_ = true;
+    return this->validate(file);
+}
+
+bool AssetPack::open_memory(const unsigned char* data, std::size_t size, const char* name)
+{
+    this->close();
+    this->data_ = data;
+    this->size_ = size;
+    return this->validate(name);
+}
+
+// bytes the payload of an entry must hold for the loader to read it, or 0 if the entry is malformed
+static std::uint64_t required_payload_size(const PackEntry& e)
+{
+    if (e.type == pack_shader)
+        return static_cast<std::uint64_t>(e.stage_size[0]) + e.stage_size[1] + e.stage_size[2] + 3;
+    if (e.type != pack_texture || (e.channels != 3 && e.channels != 4) || e.width == 0 || e.height == 0 ||
+        e.mip_levels == 0 || e.mip_levels > mip_level_count(e.width, e.height))
+        return 0;
+    std::uint64_t size = 0;
+    unsigned int width = e.width, height = e.height;
+    for (unsigned int level = 0; level < e.mip_levels; level++)
+    {
+        size += static_cast<std::uint64_t>(width) * height * e.channels;
+        width = width > 1 ? width / 2 : 1;
+        height = height > 1 ? height / 2 : 1;
+    }
+    return size;
+}
+
+bool AssetPack::validate(const char* name)
+{
+    // validate header and table of contents before anybody dereferences them
+    const PackHeader* header = reinterpret_cast<const PackHeader*>(this->data_);
+    bool valid = this->size_ >= sizeof(PackHeader)
+        && std::memcmp(header->magic, pack_magic, sizeof(pack_magic)) == 0
+        && header->version == pack_version
+        && sizeof(PackHeader) + static_cast<std::uint64_t>(header->entry_count) * sizeof(PackEntry) <= this->size_;
+    for (unsigned int i = 0; valid && i < header->entry_count; i++)
+    {
+        const PackEntry& e = this->entry(i);
+        valid = e.offset <= this->size_ && e.size <= this->size_ - e.offset && e.name[sizeof(e.name) - 1] == '\0';
+        // the payload must hold everything the loader reads from it: all mip levels, or the three terminated shader sources
+        const std::uint64_t required = required_payload_size(e);
+        valid = valid && (required != 0 || (e.type != pack_texture && e.type != pack_shader)) && required <= e.size;
+        if (valid && e.type == pack_shader)
+        {
+            const unsigned char* source = this->data_ + e.offset;
+            const std::size_t vertex_end = e.stage_size[0], fragment_end = vertex_end + 1 + e.stage_size[1];
+            const std::size_t geometry_end = fragment_end + 1 + e.stage_size[2];
+            valid = source[vertex_end] == '\0' && source[fragment_end] == '\0' && source[geometry_end] == '\0';
+        }
+    }
+    if (!valid)
+    {
+        std::cout << "ERROR::ASSET_PACK: Invalid or incompatible asset pack " << name << std::endl;
+        this->close();
+        return false;
+    }
+    return true;
+}
+
+void AssetPack::close()
+{
+    if (this->data_ == nullptr)
+        return;
+    // packs opened from memory are not owned
+    if (!this->mapped_)
+    {
+        this->data_ = nullptr;
+        this->size_ = 0;
+        return;
+    }
+#ifdef _WIN32
+    UnmapViewOfFile(this->data_);
+    CloseHandle(static_cast<HANDLE>(this->mapping_handle_));
+    CloseHandle(static_cast<HANDLE>(this->file_handle_));
+#else
+    munmap(const_cast<unsigned char*>(this->data_), this->size_);
+#endif
+    this->data_ = nullptr;
+    this->size_ = 0;
+    this->file_handle_ = nullptr;
+    this->mapping_handle_ = nullptr;
+    this->mapped_ = false;
+}
+
+unsigned int AssetPack::entry_count() const
+{
+    return this->data_ != nullptr ? reinterpret_cast<const PackHeader*>(this->data_)->entry_count : 0;
+}
+
+const PackEntry& AssetPack::entry(unsigned int index) const
+{
+    return reinterpret_cast<const PackEntry*>(this->data_ + sizeof(PackHeader))[index];
+}
+
+const unsigned char* AssetPack::payload(const PackEntry& entry) const
+{
+    return this->data_ + entry.offset;
+}
+
+
+PackEntry& AssetPackWriter::new_entry(const std::string& name, pack_entry_type type)
+{
+    PackEntry entry = {};
+    if (name.size() >= sizeof(entry.name))
+        std::cout << "WARNING::ASSET_PACK: Resource name truncated: " << name << std::endl;
+    std::strncpy(entry.name, name.c_str(), sizeof(entry.name) - 1);
+    entry.type = type;
+    this->entries_.push_back(entry);
+    this->payloads_.emplace_back();
+    return this->entries_.back();
+}
+
+void AssetPackWriter::add_texture(const std::string& name, const TextureData& data, bool mipmaps, mip_filter filter)
+{
+    PackEntry& entry = this->new_entry(name, pack_texture);
+    entry.width = data.width;
+    entry.height = data.height;
+    entry.channels = data.channels;
+    entry.mip_levels = mipmaps ? mip_level_count(data.width, data.height) : 1;
+
+    std::vector<unsigned char>& payload = this->payloads_.back();
+    const std::size_t base_size = static_cast<std::size_t>(data.width) * data.height * data.channels;
+    if (mipmaps && data.mip_levels == entry.mip_levels)
+        payload = data.mip_chain;
+    else if (mipmaps)
+        payload = build_mip_chain(data.base_level(), data.width, data.height, data.channels, filter);
+    else
+        payload.assign(data.base_level(), data.base_level() + base_size);
+}
+
+void AssetPackWriter::add_shader(const std::string& name, const std::string& vertex, const std::string& fragment, const std::string& geometry)
+{
+    PackEntry& entry = this->new_entry(name, pack_shader);
+    std::vector<unsigned char>& payload = this->payloads_.back();
+    const std::string* stages[3] = { &vertex, &fragment, &geometry };
+    for (unsigned int i = 0; i < 3; i++)
+    {
+        entry.stage_size[i] = static_cast<std::uint32_t>(stages[i]->size());
+        payload.insert(payload.end(), stages[i]->begin(), stages[i]->end());
+        payload.push_back('\0');
+    }
+}
+
+bool AssetPackWriter::write(const char* file) const
+{
+    PackHeader header = {};
+    std::memcpy(header.magic, pack_magic, sizeof(pack_magic));
+    header.version = pack_version;
+    header.entry_count = static_cast<std::uint32_t>(this->entries_.size());
+
+    // lay out the payloads after the table of contents
+    std::vector<PackEntry> entries = this->entries_;
+    std::uint64_t offset = sizeof(PackHeader) + entries.size() * sizeof(PackEntry);
+    for (std::size_t i = 0; i < entries.size(); i++)
+    {
+        offset = (offset + pack_alignment - 1) / pack_alignment * pack_alignment;
+        entries[i].offset = offset;
+        entries[i].size = this->payloads_[i].size();
+        offset += entries[i].size;
+    }
+
+    std::ofstream out(file, std::ios::binary | std::ios::trunc);
+    if (!out)
+    {
+        std::cout << "ERROR::ASSET_PACK: Failed to open " << file << " for writing" << std::endl;
+        return false;
+    }
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(entries.data()), static_cast<std::streamsize>(entries.size() * sizeof(PackEntry)));
+    static const char padding[pack_alignment] = {};
+    std::uint64_t position = sizeof(PackHeader) + entries.size() * sizeof(PackEntry);
+    for (std::size_t i = 0; i < entries.size(); i++)
+    {
+        out.write(padding, static_cast<std::streamsize>(entries[i].offset - position));
+        out.write(reinterpret_cast<const char*>(this->payloads_[i].data()), static_cast<std::streamsize>(entries[i].size));
+        position = entries[i].offset + entries[i].size;
+    }
+    return static_cast<bool>(out);
+}
\ No newline at end of file
@@ -0,0 +1,98 @@
+#ifndef ASSET_PACK_H
+#define ASSET_PACK_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "mipmap.h"
+#include "ResourceManager.h"
+
+// Asset pack file layout (little endian, offsets from the start of the file):
+//   PackHeader | PackEntry[entry_count] | payloads, each aligned to pack_alignment
+// Texture payloads hold pre-decoded pixels (optionally followed by their mip chain),
+// shader payloads hold the null-terminated vertex, fragment and geometry sources.
+constexpr char          pack_magic[4] = { 'P', 'P', 'A', 'K' };
+constexpr std::uint32_t pack_version = 1;
+constexpr std::uint64_t pack_alignment = 64;
+
+enum pack_entry_type : std::uint32_t {
+    pack_texture = 1,
+    pack_shader = 2
+};
+
+struct PackHeader
+{
+    char          magic[4];
+    std::uint32_t version;
+    std::uint32_t entry_count;
+    std::uint32_t reserved;
+};
+
+struct PackEntry
+{
+    char          name[64];      // resource name, null-terminated
+    std::uint32_t type;          // pack_entry_type
+    std::uint32_t width;         // texture: size of mip level 0
+    std::uint32_t height;
+    std::uint32_t channels;      // texture: 3 (RGB) or 4 (RGBA)
+    std::uint32_t mip_levels;    // texture: number of levels stored in the payload
+    std::uint32_t stage_size[3]; // shader: length of the vertex, fragment and geometry source (0 if absent)
+    std::uint64_t offset;        // payload position in the file
+    std::uint64_t size;          // payload size in bytes
+    std::uint32_t reserved[4];
+};
+
+static_assert(sizeof(PackHeader) == 16, "PackHeader must match the on-disk layout");
+static_assert(sizeof(PackEntry) == 128, "PackEntry must match the on-disk layout");
+
+
+// Read-only view of an asset pack. The file is memory mapped so
+// payloads can be handed to OpenGL straight from the mapping.
+// Packs compiled into the executable are used in place the same way.
+class AssetPack
+{
+public:
+    AssetPack();
+    ~AssetPack();
+    AssetPack(const AssetPack&) = delete;
+    AssetPack& operator=(const AssetPack&) = delete;
+    // maps the file and validates its table of contents
+    bool                 open(const char* file);
+    // uses a pack that is already in memory (e.g. embedded, see embedded_assets.h); data must outlive the view
+    bool                 open_memory(const unsigned char* data, std::size_t size, const char* name);
+    // unmaps the file; all pointers returned by payload() become invalid
+    void                 close();
+    unsigned int         entry_count() const;
+    const PackEntry&     entry(unsigned int index) const;
+    const unsigned char* payload(const PackEntry& entry) const;
+private:
+    const unsigned char* data_;
+    std::size_t          size_;
+    void*                file_handle_;
+    void*                mapping_handle_;
+    bool                 mapped_;
+    // checks the header and table of contents, closes the pack if they are broken
+    bool                 validate(const char* name);
+};
+
+
+// Collects decoded textures and shader sources and writes them out as an asset pack.
+// Used by the offline packer tool.
+class AssetPackWriter
+{
+public:
+    // adds decoded texture data (channels must be 3 or 4); with mipmaps the full mip chain is built with the given filter and stored as well
+    void add_texture(const std::string& name, const TextureData& data, bool mipmaps, mip_filter filter = mip_filter_box);
+    // adds shader sources; geometry may be empty
+    void add_shader(const std::string& name, const std::string& vertex, const std::string& fragment, const std::string& geometry);
+    // writes the pack to disk
+    bool write(const char* file) const;
+private:
+    std::vector<PackEntry>                  entries_;
+    std::vector<std::vector<unsigned char>> payloads_;
+    PackEntry& new_entry(const std::string& name, pack_entry_type type);
+};
+
+#endif
\ No newline at end of file
@@ -8,8 +8,8 @@
 ******************************************************************/
 #include "ball_object.h"
 
-BallObject::BallObject(glm::vec2 pos, float radius, glm::vec2 velocity, Texture2D sprite)
-    : GameObject(pos, glm::vec2(radius * 2.0f, radius * 2.0f), sprite, glm::vec3(1.0f), velocity), radius(radius), stuck(true) { }
+BallObject::BallObject(glm::vec2 pos, float radius, glm::vec2 velocity)
+    : GameObject(pos, glm::vec2(radius * 2.0f, radius * 2.0f), glm::vec3(1.0f), velocity), radius(radius), stuck(true) { }
 
 glm::vec2 BallObject::move(const float dt, const unsigned int window_width, const unsigned int window_height)
 {
@@ -36,6 +36,7 @@ glm::vec2 BallObject::move(const float dt, const unsigned int window_width, cons
 void BallObject::reset(glm::vec2 position, glm::vec2 velocity)
 {
     this->position = position;
+    this->previous_position = position; // teleport, nothing to interpolate
     this->velocity = velocity;
     this->stuck = true;
 }
\ No newline at end of file
@@ -1,10 +1,10 @@
 #ifndef BALL_OBJECT_H
 #define BALL_OBJECT_H
 
+#include "deterministic_math.h"
 #include <glm/glm.hpp>
 
 #include "game_object.h"
-#include "texture.h"
 
 
 // Ball Object inherit from GameObject and contains some extra specific functionality.
@@ -16,7 +16,7 @@ public:
     bool    stuck;
 
     // constructor(s)
-    BallObject(glm::vec2 pos, float radius, glm::vec2 velocity, Texture2D sprite);
+    BallObject(glm::vec2 pos, float radius, glm::vec2 velocity);
 
     // moves the ball
     glm::vec2 move(float dt, unsigned int window_width, unsigned int window_height);
@@ -0,0 +1,466 @@
+#include "batched_simulation.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__AVX512F__) || defined(__AVX2__) || defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <immintrin.h>
+#endif
+
+// Lane types the kernel is written against: a vector of floats, a mask of lanes and the operations on them.
+// The widest one the build targets is used, the scalar one keeps other platforms working.
+struct scalar_lanes
+{
+    typedef float vec;
+    typedef bool  mask;
+    static const unsigned int width = 1;
+    static vec  load(const float* p) { return *p; }
+    static void store(float* p, vec a) { *p = a; }
+    static vec  set(float f) { return f; }
+    static vec  add(vec a, vec b) { return a + b; }
+    static vec  sub(vec a, vec b) { return a - b; }
+    static vec  mul(vec a, vec b) { return a * b; }
+    static vec  div(vec a, vec b) { return a / b; }
+    static vec  min(vec a, vec b) { return std::min(a, b); }
+    static vec  max(vec a, vec b) { return std::max(a, b); }
+    static vec  sqrt(vec a) { return std::sqrt(a); }
+    static vec  abs(vec a) { return std::abs(a); }
+    static vec  neg(vec a) { return -a; }
+    static mask lt(vec a, vec b) { return a < b; }
+    static mask le(vec a, vec b) { return a <= b; }
+    static mask gt(vec a, vec b) { return a > b; }
+    static mask ge(vec a, vec b) { return a >= b; }
+    static mask eq(vec a, vec b) { return a == b; }
+    static mask and_(mask a, mask b) { return a && b; }
+    static mask or_(mask a, mask b) { return a || b; }
+    static mask not_(mask a) { return !a; }
+    static bool any(mask a) { return a; }
+    static vec  select(mask m, vec a, vec b) { return m ? a : b; }
+    static mask input(const unsigned char* p, unsigned char bit) { return (*p & bit) != 0; }
+    static void store_mask(unsigned char* p, mask m) { *p = m ? 1 : 0; }
+};
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+struct sse2_lanes
+{
+    typedef __m128 vec;
+    typedef __m128 mask;
+    static const unsigned int width = 4;
+    static vec  load(const float* p) { return _mm_loadu_ps(p); }
+    static void store(float* p, vec a) { _mm_storeu_ps(p, a); }
+    static vec  set(float f) { return _mm_set1_ps(f); }
+    static vec  add(vec a, vec b) { return _mm_add_ps(a, b); }
+    static vec  sub(vec a, vec b) { return _mm_sub_ps(a, b); }
+    static vec  mul(vec a, vec b) { return _mm_mul_ps(a, b); }
+    static vec  div(vec a, vec b) { return _mm_div_ps(a, b); }
+    static vec  min(vec a, vec b) { return _mm_min_ps(b, a); } // operand order of std::min for equal values
+    static vec  max(vec a, vec b) { return _mm_max_ps(b, a); }
+    static vec  sqrt(vec a) { return _mm_sqrt_ps(a); }
+    static vec  abs(vec a) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a); }
+    static vec  neg(vec a) { return _mm_xor_ps(_mm_set1_ps(-0.0f), a); }
+    static mask lt(vec a, vec b) { return _mm_cmplt_ps(a, b); }
+    static mask le(vec a, vec b) { return _mm_cmple_ps(a, b); }
+    static mask gt(vec a, vec b) { return _mm_cmpgt_ps(a, b); }
+    static mask ge(vec a, vec b) { return _mm_cmpge_ps(a, b); }
+    static mask eq(vec a, vec b) { return _mm_cmpeq_ps(a, b); }
+    static mask and_(mask a, mask b) { return _mm_and_ps(a, b); }
+    static mask or_(mask a, mask b) { return _mm_or_ps(a, b); }
+    static mask not_(mask a) { return _mm_xor_ps(a, _mm_castsi128_ps(_mm_set1_epi32(-1))); }
+    static bool any(mask a) { return _mm_movemask_ps(a) != 0; }
+    static vec  select(mask m, vec a, vec b) { return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b)); }
+    static mask input(const unsigned char* p, unsigned char bit)
+    {
+        int bytes;
+        std::memcpy(&bytes, p, sizeof(bytes));
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i lanes = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(bytes), zero), zero);
+        const __m128i flag = _mm_set1_epi32(bit);
+        return _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(lanes, flag), flag));
+    }
+    static void store_mask(unsigned char* p, mask m)
+    {
+        const int bits = _mm_movemask_ps(m);
+        for (unsigned int i = 0; i < width; i++)
+            p[i] = (bits >> i) & 1;
+    }
+};
+#endif
+
+#if defined(__AVX2__)
+struct avx2_lanes
+{
+    typedef __m256 vec;
+    typedef __m256 mask;
+    static const unsigned int width = 8;
+    static vec  load(const float* p) { return _mm256_loadu_ps(p); }
+    static void store(float* p, vec a) { _mm256_storeu_ps(p, a); }
+    static vec  set(float f) { return _mm256_set1_ps(f); }
+    static vec  add(vec a, vec b) { return _mm256_add_ps(a, b); }
+    static vec  sub(vec a, vec b) { return _mm256_sub_ps(a, b); }
+    static vec  mul(vec a, vec b) { return _mm256_mul_ps(a, b); }
+    static vec  div(vec a, vec b) { return _mm256_div_ps(a, b); }
+    static vec  min(vec a, vec b) { return _mm256_min_ps(b, a); }
+    static vec  max(vec a, vec b) { return _mm256_max_ps(b, a); }
+    static vec  sqrt(vec a) { return _mm256_sqrt_ps(a); }
+    static vec  abs(vec a) { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a); }
+    static vec  neg(vec a) { return _mm256_xor_ps(_mm256_set1_ps(-0.0f), a); }
+    static mask lt(vec a, vec b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+    static mask le(vec a, vec b) { return _mm256_cmp_ps(a, b, _CMP_LE_OQ); }
+    static mask gt(vec a, vec b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+    static mask ge(vec a, vec b) { return _mm256_cmp_ps(a, b, _CMP_GE_OQ); }
+    static mask eq(vec a, vec b) { return _mm256_cmp_ps(a, b, _CMP_EQ_OQ); }
+    static mask and_(mask a, mask b) { return _mm256_and_ps(a, b); }
+    static mask or_(mask a, mask b) { return _mm256_or_ps(a, b); }
+    static mask not_(mask a) { return _mm256_xor_ps(a, _mm256_castsi256_ps(_mm256_set1_epi32(-1))); }
+    static bool any(mask a) { return _mm256_movemask_ps(a) != 0; }
+    static vec  select(mask m, vec a, vec b) { return _mm256_blendv_ps(b, a, m); }
+    static mask input(const unsigned char* p, unsigned char bit)
+    {
+        const __m256i lanes = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(p)));
+        const __m256i flag = _mm256_set1_epi32(bit);
+        return _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(lanes, flag), flag));
+    }
+    static void store_mask(unsigned char* p, mask m)
+    {
+        const int bits = _mm256_movemask_ps(m);
+        for (unsigned int i = 0; i < width; i++)
+            p[i] = (bits >> i) & 1;
+    }
+};
+#endif
+
+#if defined(__AVX512F__)
+struct avx512_lanes
+{
+    typedef __m512    vec;
+    typedef __mmask16 mask;
+    static const unsigned int width = 16;
+    static vec  load(const float* p) { return _mm512_loadu_ps(p); }
+    static void store(float* p, vec a) { _mm512_storeu_ps(p, a); }
+    static vec  set(float f) { return _mm512_set1_ps(f); }
+    static vec  add(vec a, vec b) { return _mm512_add_ps(a, b); }
+    static vec  sub(vec a, vec b) { return _mm512_sub_ps(a, b); }
+    static vec  mul(vec a, vec b) { return _mm512_mul_ps(a, b); }
+    static vec  div(vec a, vec b) { return _mm512_div_ps(a, b); }
+    static vec  min(vec a, vec b) { return _mm512_min_ps(b, a); }
+    static vec  max(vec a, vec b) { return _mm512_max_ps(b, a); }
+    static vec  sqrt(vec a) { return _mm512_sqrt_ps(a); }
+    static vec  abs(vec a) { return _mm512_abs_ps(a); }
+    static vec  neg(vec a) { return _mm512_castsi512_ps(_mm512_xor_si512(_mm512_castps_si512(a), _mm512_set1_epi32(static_cast<int>(0x80000000u)))); }
+    static mask lt(vec a, vec b) { return _mm512_cmp_ps_mask(a, b, _CMP_LT_OQ); }
+    static mask le(vec a, vec b) { return _mm512_cmp_ps_mask(a, b, _CMP_LE_OQ); }
+    static mask gt(vec a, vec b) { return _mm512_cmp_ps_mask(a, b, _CMP_GT_OQ); }
+    static mask ge(vec a, vec b) { return _mm512_cmp_ps_mask(a, b, _CMP_GE_OQ); }
+    static mask eq(vec a, vec b) { return _mm512_cmp_ps_mask(a, b, _CMP_EQ_OQ); }
+    static mask and_(mask a, mask b) { return static_cast<mask>(a & b); }
+    static mask or_(mask a, mask b) { return static_cast<mask>(a | b); }
+    static mask not_(mask a) { return static_cast<mask>(~a); }
+    static bool any(mask a) { return a != 0; }
+    static vec  select(mask m, vec a, vec b) { return _mm512_mask_blend_ps(m, b, a); }
+    static mask input(const unsigned char* p, unsigned char bit)
+    {
+        const __m512i lanes = _mm512_cvtepu8_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));
+        return _mm512_test_epi32_mask(lanes, _mm512_set1_epi32(bit));
+    }
+    static void store_mask(unsigned char* p, mask m)
+    {
+        for (unsigned int i = 0; i < width; i++)
+            p[i] = (m >> i) & 1;
+    }
+};
+typedef avx512_lanes kernel_lanes;
+static const char* const kernel = "AVX-512";
+#elif defined(__AVX2__)
+typedef avx2_lanes kernel_lanes;
+static const char* const kernel = "AVX2";
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+typedef sse2_lanes kernel_lanes;
+static const char* const kernel = "SSE2";
+#else
+typedef scalar_lanes kernel_lanes;
+static const char* const kernel = "scalar";
+#endif
+
+// The kernels below repeat the arithmetic of Simulation (sweep_collision, BallObject::move, bounce,
+// check_collision) operation by operation, so every lane ends up with the same floats a Simulation would.
+
+// Simulation's sweep_collision against one paddle, -1 where the ball does not touch it within max_time
+template <typename L>
+static typename L::vec sweep_lanes(typename L::vec x, typename L::vec y, typename L::vec vx, typename L::vec vy, float paddle_x, typename L::vec paddle_y, typename L::vec max_time)
+{
+    typedef typename L::vec  vec;
+    typedef typename L::mask mask;
+    const vec radius = L::set(ball_radius);
+    const vec zero = L::set(0.0f);
+    const vec cx = L::add(x, radius), cy = L::add(y, radius);
+    const vec min_x = L::set(paddle_x), max_x = L::set(paddle_x + player_size.x);
+    const vec min_y = paddle_y, max_y = L::add(paddle_y, L::set(player_size.y));
+
+    // ray against the grown box, one slab per axis; an axis without motion misses when outside its slab
+    vec enter = L::set(-1.0f), exit = max_time;
+    mask miss = L::lt(zero, zero);
+    const vec lows[2] = { L::sub(min_x, radius), L::sub(min_y, radius) };
+    const vec highs[2] = { L::add(max_x, radius), L::add(max_y, radius) };
+    const vec centers[2] = { cx, cy };
+    const vec velocities[2] = { vx, vy };
+    for (int axis = 0; axis < 2; axis++)
+    {
+        const mask still = L::eq(velocities[axis], zero);
+        const mask outside = L::or_(L::lt(centers[axis], lows[axis]), L::gt(centers[axis], highs[axis]));
+        miss = L::or_(miss, L::and_(still, outside));
+        const vec near_time = L::div(L::sub(lows[axis], centers[axis]), velocities[axis]);
+        const vec far_time = L::div(L::sub(highs[axis], centers[axis]), velocities[axis]);
+        const mask swap = L::gt(near_time, far_time);
+        enter = L::select(still, enter, L::max(enter, L::select(swap, far_time, near_time)));
+        exit = L::select(still, exit, L::min(exit, L::select(swap, near_time, far_time)));
+    }
+    miss = L::or_(miss, L::or_(L::ge(enter, exit), L::lt(enter, zero)));
+
+    // entering through a grown corner: solve against the circle around the box corner
+    const vec px = L::add(cx, L::mul(vx, enter)), py = L::add(cy, L::mul(vy, enter));
+    const mask below_x = L::lt(px, min_x), below_y = L::lt(py, min_y);
+    const mask outside_x = L::or_(below_x, L::gt(px, max_x));
+    const mask outside_y = L::or_(below_y, L::gt(py, max_y));
+    const mask corner = L::and_(L::not_(miss), L::and_(outside_x, outside_y));
+    if (L::any(corner))
+    {
+        const vec ox = L::sub(cx, L::select(below_x, min_x, max_x));
+        const vec oy = L::sub(cy, L::select(below_y, min_y, max_y));
+        const vec a = L::add(L::mul(vx, vx), L::mul(vy, vy));
+        const vec b = L::add(L::mul(ox, vx), L::mul(oy, vy));
+        const vec c = L::sub(L::add(L::mul(ox, ox), L::mul(oy, oy)), L::mul(radius, radius));
+        const vec discriminant = L::sub(L::mul(b, b), L::mul(a, c));
+        const vec time = L::div(L::sub(L::neg(b), L::sqrt(L::max(discriminant, zero))), a);
+        const mask corner_miss = L::or_(L::lt(discriminant, zero), L::or_(L::lt(time, zero), L::gt(time, max_time)));
+        enter = L::select(corner, time, enter);
+        miss = L::or_(miss, L::and_(corner, corner_miss));
+    }
+    return L::select(miss, L::set(-1.0f), enter);
+}
+
+// Simulation::bounce for the lanes in hit
+template <typename L>
+static void bounce_lanes(typename L::mask hit, typename L::vec x, typename L::vec y, typename L::vec& vx, typename L::vec& vy, typename L::vec paddle_y, typename L::vec half_width)
+{
+    typedef typename L::vec vec;
+    if (!L::any(hit))
+        return;
+    const vec center_board = L::add(paddle_y, L::set(player_size.y / 2.0f));
+    const vec distance = L::sub(L::add(y, L::set(ball_radius)), center_board);
+    const vec percentage = L::div(distance, L::set(player_size.y / 2.0f));
+    constexpr float strength = 2.0f;
+    const vec new_vy = L::mul(L::mul(L::set(initial_ball_velocity.y), percentage), L::set(strength));
+    // normalize then scale by the old speed, as glm::normalize(v) * glm::length(old) does
+    const vec inverse_length = L::div(L::set(1.0f), L::sqrt(L::add(L::mul(vx, vx), L::mul(new_vy, new_vy))));
+    const vec old_length = L::sqrt(L::add(L::mul(vx, vx), L::mul(vy, vy)));
+    const vec speed_x = L::abs(L::mul(L::mul(vx, inverse_length), old_length));
+    vx = L::select(hit, L::select(L::lt(x, half_width), speed_x, L::neg(speed_x)), vx);
+    vy = L::select(hit, L::mul(L::mul(new_vy, inverse_length), old_length), vy);
+}
+
+// Simulation's check_collision (circle against paddle box)
+template <typename L>
+static typename L::mask overlap_lanes(typename L::vec x, typename L::vec y, float paddle_x, typename L::vec paddle_y)
+{
+    typedef typename L::vec vec;
+    const vec radius = L::set(ball_radius);
+    const vec half_x = L::set(player_size.x / 2.0f), half_y = L::set(player_size.y / 2.0f);
+    const vec cx = L::add(x, radius), cy = L::add(y, radius);
+    const vec box_x = L::add(L::set(paddle_x), half_x), box_y = L::add(paddle_y, half_y);
+    const vec closest_x = L::add(box_x, L::min(L::max(L::sub(cx, box_x), L::neg(half_x)), half_x));
+    const vec closest_y = L::add(box_y, L::min(L::max(L::sub(cy, box_y), L::neg(half_y)), half_y));
+    const vec dx = L::sub(closest_x, cx), dy = L::sub(closest_y, cy);
+    return L::le(L::sqrt(L::add(L::mul(dx, dx), L::mul(dy, dy))), radius);
+}
+
+// Simulation::step for the matches [first, last)
+template <typename L>
+static void step_lanes(BatchedSimulation& batch, const unsigned int first, const unsigned int last, const float dt)
+{
+    typedef typename L::vec  vec;
+    typedef typename L::mask mask;
+    const vec zero = L::set(0.0f);
+    const vec velocity = L::set(player_velocity * dt);
+    const vec half_width = L::set(static_cast<float>(batch.width / 2));
+    const vec paddle_bottom = L::set(batch.height - player_size.y);
+    const vec ball_size = L::set(ball_radius * 2.0f);
+    const vec arena_height = L::set(static_cast<float>(batch.height));
+    const vec arena_width = L::set(static_cast<float>(batch.width));
+    const vec start_y = L::set(batch.height / 2.0f - player_size.y / 2.0f);
+    const vec ball_offset_y = L::set(player_size.y / 2 - ball_radius);
+    const float player1_x = 0.0f;
+    const float player2_x = batch.width - player_size.x;
+    // ball x (left edge) beyond which a paddle cannot be touched within a step, with a pixel of margin for rounding
+    const vec reach1 = L::set(player1_x + player_size.x + 1.0f);
+    const vec reach2 = L::set(player2_x - ball_radius * 2.0f - 1.0f);
+
+    for (unsigned int i = first; i < last; i += L::width)
+    {
+        vec x = L::load(&batch.ball_x[i]), y = L::load(&batch.ball_y[i]);
+        vec vx = L::load(&batch.ball_velocity_x[i]), vy = L::load(&batch.ball_velocity_y[i]);
+        vec p1 = L::load(&batch.player1_y[i]), p2 = L::load(&batch.player2_y[i]);
+        mask stuck = L::gt(L::load(&batch.stuck[i]), zero);
+        const unsigned char* input = &batch.inputs[i];
+
+        // input: paddles move inside the arena and carry a stuck ball on their half
+        const mask left_half = L::le(x, half_width), right_half = L::ge(x, half_width);
+        mask move = L::and_(L::input(input, input_player1_up), L::ge(p1, zero));
+        p1 = L::select(move, L::sub(p1, velocity), p1);
+        y = L::select(L::and_(move, L::and_(stuck, left_half)), L::sub(y, velocity), y);
+        move = L::and_(L::input(input, input_player1_down), L::le(p1, paddle_bottom));
+        p1 = L::select(move, L::add(p1, velocity), p1);
+        y = L::select(L::and_(move, L::and_(stuck, left_half)), L::add(y, velocity), y);
+        move = L::and_(L::input(input, input_player2_up), L::ge(p2, zero));
+        p2 = L::select(move, L::sub(p2, velocity), p2);
+        y = L::select(L::and_(move, L::and_(stuck, right_half)), L::sub(y, velocity), y);
+        move = L::and_(L::input(input, input_player2_down), L::le(p2, paddle_bottom));
+        p2 = L::select(move, L::add(p2, velocity), p2);
+        y = L::select(L::and_(move, L::and_(stuck, right_half)), L::add(y, velocity), y);
+        stuck = L::and_(stuck, L::not_(L::input(input, input_launch)));
+
+        // ball: advance to the earliest paddle contact, bounce, continue with the time left (Simulation::move_ball)
+        const mask free = L::not_(stuck);
+        vec remaining = L::set(dt);
+        mask active = free;
+        for (int contact = 0; contact < 4 && L::any(active); contact++)
+        {
+            // most of the time no ball of the block is near a paddle and both sweeps can be skipped
+            vec time = remaining;
+            const vec travel = L::mul(vx, time);
+            const vec nearest = L::min(x, L::add(x, travel)), farthest = L::max(x, L::add(x, travel));
+            mask hit1 = L::lt(zero, zero), hit2 = hit1;
+            if (L::any(L::and_(active, L::le(nearest, reach1))))
+            {
+                const vec impact1 = sweep_lanes<L>(x, y, vx, vy, player1_x, p1, time);
+                hit1 = L::and_(active, L::and_(L::ge(impact1, zero), L::lt(impact1, time)));
+                time = L::select(hit1, impact1, time);
+            }
+            if (L::any(L::and_(active, L::ge(farthest, reach2))))
+            {
+                const vec impact2 = sweep_lanes<L>(x, y, vx, vy, player2_x, p2, time);
+                hit2 = L::and_(active, L::and_(L::ge(impact2, zero), L::lt(impact2, time)));
+                time = L::select(hit2, impact2, time);
+            }
+
+            // BallObject::move, bouncing off the top and bottom walls
+            x = L::select(active, L::add(x, L::mul(vx, time)), x);
+            y = L::select(active, L::add(y, L::mul(vy, time)), y);
+            const mask top = L::and_(active, L::le(y, zero));
+            const mask bottom = L::and_(L::and_(active, L::not_(top)), L::ge(L::add(y, ball_size), arena_height));
+            vy = L::select(L::or_(top, bottom), L::neg(vy), vy);
+            y = L::select(top, zero, L::select(bottom, L::sub(arena_height, ball_size), y));
+            remaining = L::select(active, L::sub(remaining, time), remaining);
+
+            const mask hit_first = L::and_(hit1, L::not_(hit2));
+            bounce_lanes<L>(hit_first, x, y, vx, vy, p1, half_width);
+            bounce_lanes<L>(hit2, x, y, vx, vy, p2, half_width);
+            active = L::and_(L::or_(hit_first, hit2), L::gt(remaining, zero));
+        }
+        // overlaps the sweep cannot see
+        bounce_lanes<L>(L::and_(free, overlap_lanes<L>(x, y, player1_x, p1)), x, y, vx, vy, p1, half_width);
+        bounce_lanes<L>(L::and_(free, overlap_lanes<L>(x, y, player2_x, p2)), x, y, vx, vy, p2, half_width);
+
+        // points: the paddles go back to the middle and the ball to the scorer's opponent
+        vec score1 = L::load(&batch.player1_score[i]), score2 = L::load(&batch.player2_score[i]);
+        const mask lost1 = L::le(x, zero);
+        score2 = L::select(lost1, L::add(score2, L::set(1.0f)), score2);
+        p1 = L::select(lost1, start_y, p1);
+        p2 = L::select(lost1, start_y, p2);
+        x = L::select(lost1, L::set(player2_x + -ball_radius * 2), x);
+        y = L::select(lost1, L::add(p2, ball_offset_y), y);
+        const mask lost2 = L::ge(L::add(x, L::set(ball_radius)), arena_width);
+        score1 = L::select(lost2, L::add(score1, L::set(1.0f)), score1);
+        p1 = L::select(lost2, start_y, p1);
+        p2 = L::select(lost2, start_y, p2);
+        x = L::select(lost2, L::set(player1_x + player_size.x), x);
+        y = L::select(lost2, L::add(p1, ball_offset_y), y);
+        const mask point = L::or_(lost1, lost2);
+        vx = L::select(point, L::set(initial_ball_velocity.x), vx);
+        vy = L::select(point, L::set(initial_ball_velocity.y), vy);
+        stuck = L::or_(stuck, point);
+        L::store(&batch.reward[i], L::select(lost2, L::set(1.0f), L::select(lost1, L::set(-1.0f), zero)));
+
+        // finished matches start over (Simulation::reset)
+        const vec points = L::set(static_cast<float>(batch.points_per_episode));
+        const mask done = L::or_(L::ge(score1, points), L::ge(score2, points));
+        score1 = L::select(done, zero, score1);
+        score2 = L::select(done, zero, score2);
+        x = L::select(done, L::set(player1_x + player_size.x), x);
+        y = L::select(done, L::add(start_y, ball_offset_y), y);
+        L::store_mask(&batch.done[i], done);
+
+        L::store(&batch.ball_x[i], x);
+        L::store(&batch.ball_y[i], y);
+        L::store(&batch.ball_velocity_x[i], vx);
+        L::store(&batch.ball_velocity_y[i], vy);
+        L::store(&batch.player1_y[i], p1);
+        L::store(&batch.player2_y[i], p2);
+        L::store(&batch.stuck[i], L::select(stuck, L::set(1.0f), zero));
+        L::store(&batch.player1_score[i], score1);
+        L::store(&batch.player2_score[i], score2);
+    }
+}
+
+BatchedSimulation::BatchedSimulation(const unsigned int count, const unsigned int width, const unsigned int height, const unsigned int points_per_episode)
+    : width(width), height(height), points_per_episode(points_per_episode), count_(count)
+{
+    // whole SIMD blocks, plus slack so the input loads of the last block stay inside the buffer
+    const std::size_t padded = (count + kernel_lanes::width - 1) / kernel_lanes::width * kernel_lanes::width;
+    for (std::vector<float>* lane : { &this->ball_x, &this->ball_y, &this->ball_velocity_x, &this->ball_velocity_y, &this->player1_y, &this->player2_y,
+                                      &this->stuck, &this->player1_score, &this->player2_score, &this->reward })
+        lane->resize(padded);
+    this->inputs.resize(padded + 16);
+    this->done.resize(padded);
+    this->reset();
+}
+
+unsigned int BatchedSimulation::count() const
+{
+    return this->count_;
+}
+
+void BatchedSimulation::reset()
+{
+    // the same starting state as a new Simulation
+    const Simulation start(this->width, this->height);
+    std::fill(this->ball_x.begin(), this->ball_x.end(), start.ball.position.x);
+    std::fill(this->ball_y.begin(), this->ball_y.end(), start.ball.position.y);
+    std::fill(this->ball_velocity_x.begin(), this->ball_velocity_x.end(), start.ball.velocity.x);
+    std::fill(this->ball_velocity_y.begin(), this->ball_velocity_y.end(), start.ball.velocity.y);
+    std::fill(this->player1_y.begin(), this->player1_y.end(), start.player1.position.y);
+    std::fill(this->player2_y.begin(), this->player2_y.end(), start.player2.position.y);
+    std::fill(this->stuck.begin(), this->stuck.end(), 1.0f);
+    std::fill(this->player1_score.begin(), this->player1_score.end(), 0.0f);
+    std::fill(this->player2_score.begin(), this->player2_score.end(), 0.0f);
+    std::fill(this->reward.begin(), this->reward.end(), 0.0f);
+    std::fill(this->inputs.begin(), this->inputs.end(), 0);
+    std::fill(this->done.begin(), this->done.end(), 0);
+}
+
+void BatchedSimulation::step(const float dt, ThreadPool* pool)
+{
+    const unsigned int padded = static_cast<unsigned int>(this->ball_x.size());
+    // blocks of a few thousand matches keep each job's state inside the L2 cache
+    constexpr unsigned int block = 4096;
+    const unsigned int blocks = (padded + block - 1) / block;
+    if (pool == nullptr || blocks < 2)
+    {
+        this->step_range(0, padded, dt);
+        return;
+    }
+    pool->parallel_for(blocks, [this, padded, dt](const unsigned int index)
+    {
+        this->step_range(index * block, std::min(padded, (index + 1) * block), dt);
+    });
+}
+
+const char* BatchedSimulation::kernel_name()
+{
+    return kernel;
+}
+
+void BatchedSimulation::step_range(const unsigned int first, const unsigned int last, const float dt)
+{
+    step_lanes<kernel_lanes>(*this, first, last, dt);
+}
\ No newline at end of file
@@ -0,0 +1,48 @@
+#ifndef BATCHED_SIMULATION_H
+#define BATCHED_SIMULATION_H
+
+#include <vector>
+
+#include "simulation.h"
+#include "thread_pool.h"
+
+// Many independent matches stepped together, for bot training and balance testing.
+// State is kept as structure of arrays and stepped with SIMD kernels (AVX-512, AVX2 or SSE2,
+// whichever the build targets) that follow the same rules as Simulation::step. A match that
+// reaches points_per_episode is reset in the same step and flagged in done.
+class BatchedSimulation
+{
+public:
+    // arena size and match length, shared by all matches
+    unsigned int width, height;
+    unsigned int points_per_episode;
+
+    // match state, one entry per match (padded to a multiple of the SIMD width)
+    std::vector<float>         ball_x, ball_y, ball_velocity_x, ball_velocity_y;
+    std::vector<float>         player1_y, player2_y; // paddles only move vertically
+    std::vector<float>         stuck;                // 1.0f while the ball sits on a paddle
+    std::vector<float>         player1_score, player2_score;
+    // input of the next step as input_bit flags, filled by the caller
+    std::vector<unsigned char> inputs;
+    // results of the last step
+    std::vector<float>         reward; // +1.0f when player1 scored, -1.0f when player2 did
+    std::vector<unsigned char> done;   // 1 when the match ended and was reset
+
+    // constructor
+    BatchedSimulation(unsigned int count, unsigned int width, unsigned int height, unsigned int points_per_episode = 11);
+
+    // number of matches
+    unsigned int count() const;
+    // starts every match over
+    void         reset();
+    // advances every match by one step with its inputs; blocks of matches are spread over the pool when one is given
+    void         step(float dt, ThreadPool* pool = nullptr);
+    // name of the SIMD kernel in use
+    static const char* kernel_name();
+private:
+    unsigned int count_;
+    // steps the matches [first, last), last being a multiple of the SIMD width
+    void step_range(unsigned int first, unsigned int last, float dt);
+};
+
+#endif
\ No newline at end of file
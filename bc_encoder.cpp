@@ -0,0 +1,173 @@
+#include "bc_encoder.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <cstdint>
+
+
+// 8 bit color to 5:6:5 and back (with bit replication, as the GPU expands it)
+static std::uint16_t pack_565(float r, float g, float b)
+{
+    const int r5 = static_cast<int>(std::lround(std::fmin(std::fmax(r, 0.0f), 255.0f) * 31.0f / 255.0f));
+    const int g6 = static_cast<int>(std::lround(std::fmin(std::fmax(g, 0.0f), 255.0f) * 63.0f / 255.0f));
+    const int b5 = static_cast<int>(std::lround(std::fmin(std::fmax(b, 0.0f), 255.0f) * 31.0f / 255.0f));
+    return static_cast<std::uint16_t>(r5 << 11 | g6 << 5 | b5);
+}
+
+static void unpack_565(std::uint16_t color, int rgb[3])
+{
+    const int r5 = color >> 11 & 31, g6 = color >> 5 & 63, b5 = color & 31;
+    rgb[0] = r5 << 3 | r5 >> 2;
+    rgb[1] = g6 << 2 | g6 >> 4;
+    rgb[2] = b5 << 3 | b5 >> 2;
+}
+
+void encode_bc1_block(const unsigned char* rgba, unsigned char* block)
+{
+    // mean and covariance of the 16 colors
+    float mean[3] = { 0.0f, 0.0f, 0.0f };
+    for (int i = 0; i < 16; i++)
+        for (int c = 0; c < 3; c++)
+            mean[c] += rgba[i * 4 + c] / 16.0f;
+    float covariance[6] = { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f }; // rr rg rb gg gb bb
+    for (int i = 0; i < 16; i++)
+    {
+        const float r = rgba[i * 4] - mean[0], g = rgba[i * 4 + 1] - mean[1], b = rgba[i * 4 + 2] - mean[2];
+        covariance[0] += r * r; covariance[1] += r * g; covariance[2] += r * b;
+        covariance[3] += g * g; covariance[4] += g * b; covariance[5] += b * b;
+    }
+    // principal axis by power iteration
+    float axis[3] = { 1.0f, 1.0f, 1.0f };
+    for (int iteration = 0; iteration < 8; iteration++)
+    {
+        const float x = covariance[0] * axis[0] + covariance[1] * axis[1] + covariance[2] * axis[2];
+        const float y = covariance[1] * axis[0] + covariance[3] * axis[1] + covariance[4] * axis[2];
+        const float z = covariance[2] * axis[0] + covariance[4] * axis[1] + covariance[5] * axis[2];
+        const float length = std::sqrt(x * x + y * y + z * z);
+        if (length < 1e-6f)
+            break;
+        axis[0] = x / length; axis[1] = y / length; axis[2] = z / length;
+    }
+    // endpoints are the extreme projections onto the axis
+    float min_t = 0.0f, max_t = 0.0f;
+    for (int i = 0; i < 16; i++)
+    {
+        const float t = (rgba[i * 4] - mean[0]) * axis[0] + (rgba[i * 4 + 1] - mean[1]) * axis[1] + (rgba[i * 4 + 2] - mean[2]) * axis[2];
+        min_t = std::fmin(min_t, t);
+        max_t = std::fmax(max_t, t);
+    }
+    std::uint16_t color0 = pack_565(mean[0] + axis[0] * max_t, mean[1] + axis[1] * max_t, mean[2] + axis[2] * max_t);
+    std::uint16_t color1 = pack_565(mean[0] + axis[0] * min_t, mean[1] + axis[1] * min_t, mean[2] + axis[2] * min_t);
+    // color0 > color1 selects the 4-color mode (the only mode for the color part of BC3)
+    if (color0 < color1)
+    {
+        const std::uint16_t swap = color0;
+        color0 = color1;
+        color1 = swap;
+    }
+
+    std::uint32_t indices = 0;
+    if (color0 != color1)
+    {
+        int palette[4][3];
+        unpack_565(color0, palette[0]);
+        unpack_565(color1, palette[1]);
+        for (int c = 0; c < 3; c++)
+        {
+            palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+            palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+        }
+        for (int i = 0; i < 16; i++)
+        {
+            int best = 0, best_distance = 1 << 30;
+            for (int p = 0; p < 4; p++)
+            {
+                const int dr = rgba[i * 4] - palette[p][0], dg = rgba[i * 4 + 1] - palette[p][1], db = rgba[i * 4 + 2] - palette[p][2];
+                const int distance = dr * dr + dg * dg + db * db;
+                if (distance < best_distance)
+                {
+                    best_distance = distance;
+                    best = p;
+                }
+            }
+            indices |= static_cast<std::uint32_t>(best) << (i * 2);
+        }
+    }
+
+    block[0] = static_cast<unsigned char>(color0); block[1] = static_cast<unsigned char>(color0 >> 8);
+    block[2] = static_cast<unsigned char>(color1); block[3] = static_cast<unsigned char>(color1 >> 8);
+    for (int i = 0; i < 4; i++)
+        block[4 + i] = static_cast<unsigned char>(indices >> (i * 8));
+}
+
+// BC3 alpha block: two 8 bit endpoints and 16 3 bit indices into an 8 entry ramp
+static void encode_alpha_block(const unsigned char* rgba, unsigned char* block)
+{
+    int alpha0 = 0, alpha1 = 255;
+    for (int i = 0; i < 16; i++)
+    {
+        alpha0 = rgba[i * 4 + 3] > alpha0 ? rgba[i * 4 + 3] : alpha0;
+        alpha1 = rgba[i * 4 + 3] < alpha1 ? rgba[i * 4 + 3] : alpha1;
+    }
+    // alpha0 > alpha1 selects the 8 value ramp: 0 -> alpha0, 1 -> alpha1, 2..7 in between
+    int ramp[8] = { alpha0, alpha1 };
+    for (int k = 2; k < 8; k++)
+        ramp[k] = ((8 - k) * alpha0 + (k - 1) * alpha1) / 7;
+
+    std::uint64_t indices = 0;
+    for (int i = 0; i < 16 && alpha0 != alpha1; i++)
+    {
+        int best = 0, best_distance = 256;
+        for (int k = 0; k < 8; k++)
+        {
+            const int distance = std::abs(rgba[i * 4 + 3] - ramp[k]);
+            if (distance < best_distance)
+            {
+                best_distance = distance;
+                best = k;
+            }
+        }
+        indices |= static_cast<std::uint64_t>(best) << (i * 3);
+    }
+    block[0] = static_cast<unsigned char>(alpha0);
+    block[1] = static_cast<unsigned char>(alpha1);
+    for (int i = 0; i < 6; i++)
+        block[2 + i] = static_cast<unsigned char>(indices >> (i * 8));
+}
+
+void encode_bc3_block(const unsigned char* rgba, unsigned char* block)
+{
+    encode_alpha_block(rgba, block);
+    encode_bc1_block(rgba, block + 8);
+}
+
+std::vector<unsigned char> compress_image(const unsigned char* pixels, unsigned int width, unsigned int height, unsigned int channels, unsigned int format)
+{
+    const unsigned int block_size = compressed_block_size(format);
+    std::vector<unsigned char> blocks(compressed_image_size(format, width, height));
+    unsigned char* out = blocks.data();
+    unsigned char rgba[64];
+    for (unsigned int by = 0; by < height; by += 4)
+    {
+        for (unsigned int bx = 0; bx < width; bx += 4)
+        {
+            // gather the block as RGBA, repeating the last row/column past the image edge
+            for (unsigned int i = 0; i < 16; i++)
+            {
+                const unsigned int x = bx + i % 4 < width ? bx + i % 4 : width - 1;
+                const unsigned int y = by + i / 4 < height ? by + i / 4 : height - 1;
+                const unsigned char* texel = pixels + (static_cast<std::size_t>(y) * width + x) * channels;
+                rgba[i * 4] = texel[0];
+                rgba[i * 4 + 1] = texel[1];
+                rgba[i * 4 + 2] = texel[2];
+                rgba[i * 4 + 3] = channels == 4 ? texel[3] : 255;
+            }
+            if (format == compressed_bc3)
+                encode_bc3_block(rgba, out);
+            else
+                encode_bc1_block(rgba, out);
+            out += block_size;
+        }
+    }
+    return blocks;
+}
\ No newline at end of file
@@ -0,0 +1,20 @@
+#ifndef BC_ENCODER_H
+#define BC_ENCODER_H
+
+#include <vector>
+
+#include "compressed_texture.h"
+
+// CPU block compressor used by the offline texture compressor.
+// Encodes BC1 (opaque, 4 bits per texel) and BC3 (with alpha, 8 bits per texel)
+// with a principal-axis endpoint fit. BC7 and ETC2 files can be loaded at
+// runtime but have to be produced by an external encoder.
+
+// encodes one 4x4 block of RGBA texels (row-major, 64 bytes) into 8 bytes of BC1 color data
+void encode_bc1_block(const unsigned char* rgba, unsigned char* block);
+// encodes one 4x4 block of RGBA texels into 16 bytes of BC3 data (alpha block followed by color block)
+void encode_bc3_block(const unsigned char* rgba, unsigned char* block);
+// compresses a tightly packed RGB or RGBA image to compressed_bc1_rgb or compressed_bc3; edge blocks repeat the last texel
+std::vector<unsigned char> compress_image(const unsigned char* pixels, unsigned int width, unsigned int height, unsigned int channels, unsigned int format);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,239 @@
+#include "compressed_texture.h"
+
+#include <cctype>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+
+
+// DDS header layout (https://learn.microsoft.com/windows/win32/direct3ddds/dds-header)
+struct DdsPixelFormat
+{
+    std::uint32_t size, flags, four_cc, rgb_bit_count, r_mask, g_mask, b_mask, a_mask;
+};
+struct DdsHeader
+{
+    std::uint32_t  size, flags, height, width, pitch_or_linear_size, depth, mip_map_count, reserved1[11];
+    DdsPixelFormat pixel_format;
+    std::uint32_t  caps, caps2, caps3, caps4, reserved2;
+};
+struct DdsHeaderDx10
+{
+    std::uint32_t dxgi_format, resource_dimension, misc_flag, array_size, misc_flags2;
+};
+static_assert(sizeof(DdsHeader) == 124, "DdsHeader must match the on-disk layout");
+
+constexpr std::uint32_t dds_flags_required = 0x1 | 0x2 | 0x4 | 0x1000; // caps, height, width, pixel format
+constexpr std::uint32_t dds_flag_mipmap_count = 0x20000;
+constexpr std::uint32_t dds_flag_linear_size = 0x80000;
+constexpr std::uint32_t dds_pixel_format_four_cc = 0x4;
+constexpr std::uint32_t dds_caps_texture = 0x1000, dds_caps_complex = 0x8, dds_caps_mipmap = 0x400000;
+
+static std::uint32_t four_cc(const char code[4])
+{
+    return static_cast<std::uint32_t>(static_cast<unsigned char>(code[0])) | static_cast<std::uint32_t>(static_cast<unsigned char>(code[1])) << 8
+        | static_cast<std::uint32_t>(static_cast<unsigned char>(code[2])) << 16 | static_cast<std::uint32_t>(static_cast<unsigned char>(code[3])) << 24;
+}
+
+// DXGI_FORMAT values of the block formats we understand (sRGB variants load as UNORM, we do no sRGB conversion)
+static unsigned int format_from_dxgi(std::uint32_t dxgi_format)
+{
+    switch (dxgi_format)
+    {
+    case 71: case 72: return compressed_bc1_rgba;
+    case 77: case 78: return compressed_bc3;
+    case 98: case 99: return compressed_bc7;
+    default: return 0;
+    }
+}
+
+// VkFormat values of the block formats we understand
+static unsigned int format_from_vulkan(std::uint32_t vk_format)
+{
+    switch (vk_format)
+    {
+    case 131: case 132: return compressed_bc1_rgb;
+    case 133: case 134: return compressed_bc1_rgba;
+    case 137: case 138: return compressed_bc3;
+    case 145: case 146: return compressed_bc7;
+    case 147: case 148: return compressed_etc2_rgb;
+    case 151: case 152: return compressed_etc2_rgba;
+    default: return 0;
+    }
+}
+
+unsigned int compressed_block_size(unsigned int format)
+{
+    switch (format)
+    {
+    case compressed_bc1_rgb:
+    case compressed_bc1_rgba:
+    case compressed_etc2_rgb:
+        return 8;
+    case compressed_bc3:
+    case compressed_bc7:
+    case compressed_etc2_rgba:
+        return 16;
+    default:
+        return 0;
+    }
+}
+
+std::size_t compressed_image_size(unsigned int format, unsigned int width, unsigned int height)
+{
+    return static_cast<std::size_t>((width + 3) / 4) * ((height + 3) / 4) * compressed_block_size(format);
+}
+
+// total size of a mip chain, or 0 if it does not fit in available bytes
+static std::size_t chain_size(const CompressedImage& image)
+{
+    std::size_t size = 0;
+    unsigned int width = image.width, height = image.height;
+    for (unsigned int level = 0; level < image.mip_levels; level++)
+    {
+        size += compressed_image_size(image.format, width, height);
+        width = width > 1 ? width / 2 : 1;
+        height = height > 1 ? height / 2 : 1;
+    }
+    return size;
+}
+
+bool is_compressed_texture_file(const char* file)
+{
+    const std::string name = file;
+    const std::size_t dot = name.find_last_of('.');
+    if (dot == std::string::npos)
+        return false;
+    std::string extension = name.substr(dot + 1);
+    for (char& c : extension)
+        c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    return extension == "dds" || extension == "ktx2";
+}
+
+static bool load_dds(const std::vector<unsigned char>& file, CompressedImage& image)
+{
+    if (file.size() < 4 + sizeof(DdsHeader))
+        return false;
+    DdsHeader header;
+    std::memcpy(&header, file.data() + 4, sizeof(header));
+    std::size_t offset = 4 + sizeof(DdsHeader);
+    if (header.size != sizeof(DdsHeader) || !(header.pixel_format.flags & dds_pixel_format_four_cc))
+        return false;
+
+    if (header.pixel_format.four_cc == four_cc("DXT1"))
+        image.format = compressed_bc1_rgba;
+    else if (header.pixel_format.four_cc == four_cc("DXT5"))
+        image.format = compressed_bc3;
+    else if (header.pixel_format.four_cc == four_cc("DX10") && file.size() >= offset + sizeof(DdsHeaderDx10))
+    {
+        DdsHeaderDx10 dx10;
+        std::memcpy(&dx10, file.data() + offset, sizeof(dx10));
+        offset += sizeof(dx10);
+        image.format = format_from_dxgi(dx10.dxgi_format);
+    }
+    else
+        image.format = 0;
+    if (image.format == 0)
+        return false;
+
+    image.width = header.width;
+    image.height = header.height;
+    image.mip_levels = (header.flags & dds_flag_mipmap_count) && header.mip_map_count > 0 ? header.mip_map_count : 1;
+    const std::size_t size = chain_size(image);
+    if (file.size() - offset < size)
+        return false;
+    image.data.assign(file.begin() + offset, file.begin() + offset + size);
+    return true;
+}
+
+static bool load_ktx2(const std::vector<unsigned char>& file, CompressedImage& image)
+{
+    static const unsigned char identifier[12] = { 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+    // identifier, 9 header fields, 4 index fields and 2 64 bit index fields
+    constexpr std::size_t header_size = 12 + 9 * 4 + 4 * 4 + 2 * 8;
+    if (file.size() < header_size || std::memcmp(file.data(), identifier, sizeof(identifier)) != 0)
+        return false;
+    std::uint32_t fields[9]; // vkFormat, typeSize, width, height, depth, layerCount, faceCount, levelCount, supercompressionScheme
+    std::memcpy(fields, file.data() + 12, sizeof(fields));
+    image.format = format_from_vulkan(fields[0]);
+    image.width = fields[2];
+    image.height = fields[3];
+    image.mip_levels = fields[7] > 0 ? fields[7] : 1;
+    // only plain 2D textures without supercompression (Basis/zstd) can be uploaded directly
+    if (image.format == 0 || fields[4] > 1 || fields[5] > 1 || fields[6] != 1 || fields[8] != 0)
+        return false;
+    if (file.size() < header_size + static_cast<std::size_t>(image.mip_levels) * 24)
+        return false;
+
+    image.data.clear();
+    image.data.reserve(chain_size(image));
+    unsigned int width = image.width, height = image.height;
+    for (unsigned int level = 0; level < image.mip_levels; level++)
+    {
+        std::uint64_t level_index[3]; // byteOffset, byteLength, uncompressedByteLength
+        std::memcpy(level_index, file.data() + header_size + level * sizeof(level_index), sizeof(level_index));
+        const std::size_t expected = compressed_image_size(image.format, width, height);
+        if (level_index[1] != expected || level_index[0] > file.size() || file.size() - level_index[0] < expected)
+            return false;
+        image.data.insert(image.data.end(), file.begin() + static_cast<std::ptrdiff_t>(level_index[0]), file.begin() + static_cast<std::ptrdiff_t>(level_index[0] + expected));
+        width = width > 1 ? width / 2 : 1;
+        height = height > 1 ? height / 2 : 1;
+    }
+    return true;
+}
+
+bool load_compressed_texture(const char* file, CompressedImage& image)
+{
+    std::ifstream in(file, std::ios::binary);
+    const std::vector<unsigned char> contents((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    const bool loaded = contents.size() >= 4 && std::memcmp(contents.data(), "DDS ", 4) == 0
+        ? load_dds(contents, image)
+        : load_ktx2(contents, image);
+    if (!loaded)
+        std::cout << "ERROR::TEXTURE: Failed to load compressed texture " << file << " (unsupported format or corrupt file)" << std::endl;
+    return loaded;
+}
+
+bool save_dds(const char* file, const CompressedImage& image)
+{
+    DdsHeader header = {};
+    header.size = sizeof(DdsHeader);
+    header.flags = dds_flags_required | dds_flag_linear_size | (image.mip_levels > 1 ? dds_flag_mipmap_count : 0);
+    header.width = image.width;
+    header.height = image.height;
+    header.pitch_or_linear_size = static_cast<std::uint32_t>(compressed_image_size(image.format, image.width, image.height));
+    header.mip_map_count = image.mip_levels;
+    header.pixel_format.size = sizeof(DdsPixelFormat);
+    header.pixel_format.flags = dds_pixel_format_four_cc;
+    header.caps = dds_caps_texture | (image.mip_levels > 1 ? dds_caps_complex | dds_caps_mipmap : 0);
+
+    DdsHeaderDx10 dx10 = {};
+    const bool extended = image.format != compressed_bc1_rgb && image.format != compressed_bc1_rgba && image.format != compressed_bc3;
+    if (image.format == compressed_bc1_rgb || image.format == compressed_bc1_rgba)
+        header.pixel_format.four_cc = four_cc("DXT1");
+    else if (image.format == compressed_bc3)
+        header.pixel_format.four_cc = four_cc("DXT5");
+    else if (image.format == compressed_bc7)
+    {
+        header.pixel_format.four_cc = four_cc("DX10");
+        dx10.dxgi_format = 98;
+        dx10.resource_dimension = 3; // texture 2D
+        dx10.array_size = 1;
+    }
+    else
+    {
+        std::cout << "ERROR::TEXTURE: DDS cannot hold format 0x" << std::hex << image.format << std::dec << std::endl;
+        return false;
+    }
+
+    std::ofstream out(file, std::ios::binary | std::ios::trunc);
+    out.write("DDS ", 4);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    if (extended)
+        out.write(reinterpret_cast<const char*>(&dx10), sizeof(dx10));
+    out.write(reinterpret_cast<const char*>(image.data.data()), static_cast<std::streamsize>(image.data.size()));
+    return static_cast<bool>(out);
+}
\ No newline at end of file
@@ -0,0 +1,37 @@
+#ifndef COMPRESSED_TEXTURE_H
+#define COMPRESSED_TEXTURE_H
+
+#include <cstddef>
+#include <vector>
+
+// GL enums of the supported block-compressed formats. S3TC comes from
+// GL_EXT_texture_compression_s3tc, BPTC (BC7) and ETC2 are core in GL 4.2/4.3;
+// none of them are part of our 3.3 loader.
+constexpr unsigned int compressed_bc1_rgb = 0x83F0;  // GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+constexpr unsigned int compressed_bc1_rgba = 0x83F1; // GL_COMPRESSED_RGBA_S3TC_DXT1_EXT
+constexpr unsigned int compressed_bc3 = 0x83F3;      // GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+constexpr unsigned int compressed_bc7 = 0x8E8C;      // GL_COMPRESSED_RGBA_BPTC_UNORM
+constexpr unsigned int compressed_etc2_rgb = 0x9274; // GL_COMPRESSED_RGB8_ETC2
+constexpr unsigned int compressed_etc2_rgba = 0x9278; // GL_COMPRESSED_RGBA8_ETC2_EAC
+
+// A block-compressed image with its mip chain, as stored in a DDS or KTX2 container
+struct CompressedImage
+{
+    unsigned int               format;     // one of the compressed_* GL enums
+    unsigned int               width, height;
+    unsigned int               mip_levels;
+    std::vector<unsigned char> data;       // all levels, tightly packed, level 0 first
+};
+
+// size in bytes of one 4x4 block of the format (0 if the format is unknown)
+unsigned int compressed_block_size(unsigned int format);
+// size in bytes of one image of the given size
+std::size_t  compressed_image_size(unsigned int format, unsigned int width, unsigned int height);
+// true if the file name ends in .dds or .ktx2
+bool         is_compressed_texture_file(const char* file);
+// reads a DDS (BC1/BC3/BC7) or KTX2 (BC1/BC3/BC7/ETC2, no supercompression) file
+bool         load_compressed_texture(const char* file, CompressedImage& image);
+// writes a DDS file (BC1/BC3 use the legacy header, other formats the DX10 extension header)
+bool         save_dds(const char* file, const CompressedImage& image);
+
+#endif
\ No newline at end of file
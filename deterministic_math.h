@@ -0,0 +1,24 @@
+#ifndef DETERMINISTIC_MATH_H
+#define DETERMINISTIC_MATH_H
+
+// The simulation must produce bit-identical results across builds and machines (lockstep multiplayer,
+// replay verification, desync detection). Every header of the simulation includes this one before any
+// math, restricting the code that follows to plain IEEE single precision: no fast-math, no x87 extended
+// precision, and no fusing of a multiply and an add into one instruction, which compilers otherwise do
+// when they target FMA hardware (/arch:AVX2, -march=native) and which changes the rounding.
+// The projects that build the simulation turn contraction off for the whole build (/fp:precise);
+// GCC has no scoped form of the pragma, so GCC builds need -ffp-contract=off on the command line.
+#if defined(__FAST_MATH__) || defined(_M_FP_FAST)
+#error "the simulation must not be built with fast floating point math (/fp:fast, -ffast-math)"
+#endif
+#if (defined(_M_IX86) && (!defined(_M_IX86_FP) || _M_IX86_FP < 2)) || (defined(__i386__) && !defined(__SSE2_MATH__))
+#error "the simulation must be built with SSE2 floating point on 32-bit x86, not x87"
+#endif
+
+#if defined(__clang__)
+#pragma clang fp contract(off)
+#elif defined(_MSC_VER)
+#pragma fp_contract(off)
+#endif
+
+#endif
\ No newline at end of file
@@ -0,0 +1,14 @@
+#include "draw_system.h"
+
+void draw_system(const EntityStore& store, SpriteRenderer& renderer, const Texture2D* textures, const float alpha)
+{
+    constexpr unsigned char drawn = component_transform | component_sprite;
+    for (std::size_t i = 0; i < store.size(); i++)
+    {
+        if ((store.mask[i] & drawn) != drawn)
+            continue;
+        const Transform& transform = store.transform[i];
+        const glm::vec2 position = glm::mix(transform.previous_position, transform.position, alpha);
+        renderer.draw_sprite(textures[store.sprite[i].texture], position - transform.size * 0.5f, transform.size, 0.0f, store.sprite[i].color);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,12 @@
+#ifndef DRAW_SYSTEM_H
+#define DRAW_SYSTEM_H
+
+#include "entity_store.h"
+#include "sprite_renderer.h"
+#include "texture.h"
+
+// draws every entity with a transform and a sprite, in slot order, between its previous and current
+// position (alpha being the fraction of a step left unsimulated); sprite.texture indexes textures
+void draw_system(const EntityStore& store, SpriteRenderer& renderer, const Texture2D* textures, float alpha = 1.0f);
+
+#endif
\ No newline at end of file
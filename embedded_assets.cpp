@@ -0,0 +1,22 @@
+#include "embedded_assets.h"
+
+#include <cstring>
+
+#ifdef EMBED_ASSETS
+// generated by the Asset Embedder tool: defines embedded_assets[] and embedded_asset_count
+#include "embedded_assets.inc"
+#else
+static const EmbeddedAsset embedded_assets[] = { { "", nullptr, 0 } };
+static const std::size_t   embedded_asset_count = 0;
+#endif
+
+
+const EmbeddedAsset* find_embedded_asset(const char* name)
+{
+    for (std::size_t i = 0; i < embedded_asset_count; i++)
+    {
+        if (std::strcmp(embedded_assets[i].name, name) == 0)
+            return &embedded_assets[i];
+    }
+    return nullptr;
+}
\ No newline at end of file
@@ -0,0 +1,19 @@
+#ifndef EMBEDDED_ASSETS_H
+#define EMBEDDED_ASSETS_H
+
+#include <cstddef>
+
+
+// A file compiled into the executable, looked up by the path it was embedded from
+struct EmbeddedAsset
+{
+    const char*          name;
+    const unsigned char* data;
+    std::size_t          size;
+};
+
+// the embedded file with the given path (e.g. "shaders/sprite.vs"), or nullptr if it was not embedded.
+// Without EMBED_ASSETS nothing is embedded and every lookup returns nullptr
+const EmbeddedAsset* find_embedded_asset(const char* name);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,165 @@
+#include "entity_store.h"
+
+#include <iostream>
+
+static std::uint32_t entity_index(const Entity entity)
+{
+    return entity & entity_index_mask;
+}
+
+EntityStore::EntityStore()
+    : version_(0)
+{
+
+}
+
+Entity EntityStore::create(const unsigned char components)
+{
+    std::uint32_t index;
+    if (!this->free_.empty())
+    {
+        index = this->free_.back();
+        this->free_.pop_back();
+    }
+    else
+    {
+        if (this->slots_.size() > entity_index_mask)
+        {
+            std::cout << "ERROR::ENTITY: More than " << entity_index_mask + 1 << " entities" << std::endl;
+            return no_entity;
+        }
+        index = static_cast<std::uint32_t>(this->slots_.size());
+        this->slots_.push_back(no_entity);
+        this->generations_.push_back(0);
+    }
+    const Entity entity = (this->generations_[index] << entity_index_bits) | index;
+    this->slots_[index] = static_cast<std::uint32_t>(this->entities_.size());
+    this->entities_.push_back(entity);
+    this->mask.push_back(components);
+    this->transform.push_back(Transform());
+    this->velocity.push_back(Velocity());
+    this->collider.push_back(Collider());
+    this->sprite.push_back(Sprite());
+    this->version_++;
+    return entity;
+}
+
+void EntityStore::destroy(const Entity entity)
+{
+    if (!this->alive(entity))
+        return;
+    // the last entity fills the hole, so the arrays stay packed
+    const std::size_t hole = this->slots_[entity_index(entity)];
+    const std::size_t last = this->entities_.size() - 1;
+    if (hole != last)
+    {
+        this->mask[hole] = this->mask[last];
+        this->transform[hole] = this->transform[last];
+        this->velocity[hole] = this->velocity[last];
+        this->collider[hole] = this->collider[last];
+        this->sprite[hole] = this->sprite[last];
+        this->entities_[hole] = this->entities_[last];
+        this->slots_[entity_index(this->entities_[hole])] = static_cast<std::uint32_t>(hole);
+    }
+    this->mask.pop_back();
+    this->transform.pop_back();
+    this->velocity.pop_back();
+    this->collider.pop_back();
+    this->sprite.pop_back();
+    this->entities_.pop_back();
+    this->release_index(entity);
+    this->version_++;
+}
+
+void EntityStore::clear()
+{
+    this->mask.clear();
+    this->transform.clear();
+    this->velocity.clear();
+    this->collider.clear();
+    this->sprite.clear();
+    // the slot map is kept, so handles from before the clear stay dead instead of naming new entities
+    for (const Entity entity : this->entities_)
+        this->release_index(entity);
+    this->entities_.clear();
+    this->version_++;
+}
+
+void EntityStore::release_index(const Entity entity)
+{
+    const std::uint32_t index = entity_index(entity);
+    this->slots_[index] = no_entity;
+    // generations wrap within the bits above the index, skipping the one that would spell no_entity
+    std::uint32_t& generation = this->generations_[index];
+    generation = (generation + 1) & (no_entity >> entity_index_bits);
+    if (((generation << entity_index_bits) | index) == no_entity)
+        generation = 0;
+    this->free_.push_back(index);
+}
+
+void EntityStore::reserve(const std::size_t count)
+{
+    this->mask.reserve(count);
+    this->transform.reserve(count);
+    this->velocity.reserve(count);
+    this->collider.reserve(count);
+    this->sprite.reserve(count);
+    this->entities_.reserve(count);
+    this->slots_.reserve(count);
+    this->generations_.reserve(count);
+}
+
+bool EntityStore::alive(const Entity entity) const
+{
+    const std::uint32_t index = entity_index(entity);
+    return index < this->slots_.size() && this->slots_[index] != no_entity && this->entities_[this->slots_[index]] == entity;
+}
+
+std::size_t EntityStore::slot(const Entity entity) const
+{
+    return this->alive(entity) ? this->slots_[entity_index(entity)] : no_slot;
+}
+
+Entity EntityStore::entity_at(const std::size_t slot) const
+{
+    return this->entities_[slot];
+}
+
+std::size_t EntityStore::size() const
+{
+    return this->entities_.size();
+}
+
+std::uint64_t EntityStore::version() const
+{
+    return this->version_;
+}
+
+void EntityStore::reorder(const std::vector<unsigned int>& order)
+{
+    // one gather pass over all arrays into the spare ones, which then take their place
+    const std::size_t count = this->entities_.size();
+    this->spare_mask_.resize(count);
+    this->spare_transform_.resize(count);
+    this->spare_velocity_.resize(count);
+    this->spare_collider_.resize(count);
+    this->spare_sprite_.resize(count);
+    this->spare_entities_.resize(count);
+    for (std::size_t i = 0; i < count; i++)
+    {
+        const unsigned int from = order[i];
+        this->spare_mask_[i] = this->mask[from];
+        this->spare_transform_[i] = this->transform[from];
+        this->spare_velocity_[i] = this->velocity[from];
+        this->spare_collider_[i] = this->collider[from];
+        this->spare_sprite_[i] = this->sprite[from];
+        this->spare_entities_[i] = this->entities_[from];
+        this->slots_[entity_index(this->spare_entities_[i])] = static_cast<std::uint32_t>(i);
+    }
+    this->mask.swap(this->spare_mask_);
+    this->transform.swap(this->spare_transform_);
+    this->velocity.swap(this->spare_velocity_);
+    this->collider.swap(this->spare_collider_);
+    this->sprite.swap(this->spare_sprite_);
+    this->entities_.swap(this->spare_entities_);
+}
\ No newline at end of file
@@ -0,0 +1,104 @@
+#ifndef ENTITY_STORE_H
+#define ENTITY_STORE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "deterministic_math.h"
+#include <glm/glm.hpp>
+
+// Handle of an entity; stays valid while the store moves the entity's components around. The low
+// entity_index_bits index the slot map, the bits above hold a generation that changes whenever the
+// index is freed, so a handle of a destroyed entity never matches the entity that reuses its index.
+typedef std::uint32_t Entity;
+constexpr Entity        no_entity = 0xffffffffu;
+constexpr unsigned int  entity_index_bits = 22;
+constexpr Entity        entity_index_mask = (1u << entity_index_bits) - 1;
+constexpr std::size_t   no_slot = static_cast<std::size_t>(-1);
+
+// Components an entity can have, as mask bits
+enum component : unsigned char {
+    component_transform = 1 << 0,
+    component_velocity  = 1 << 1,
+    component_collider  = 1 << 2,
+    component_sprite    = 1 << 3
+};
+
+struct Transform
+{
+    glm::vec2 position;          // center
+    glm::vec2 size;              // full extent; a circle's is its diameter
+    glm::vec2 previous_position; // center at the start of the current step, rendering interpolates from it
+};
+
+struct Velocity
+{
+    glm::vec2 value;
+};
+
+enum collider_shape : unsigned char {
+    collider_circle, // radius; moving colliders are circles
+    collider_box     // the transform's extent; boxes are static
+};
+
+struct Collider
+{
+    collider_shape shape;
+    float          radius;
+};
+
+struct Sprite
+{
+    unsigned int texture; // index into the texture table given to draw_system
+    glm::vec3    color;
+};
+
+// Data-oriented entity storage: one packed array per component, all indexed by the same slot, and a
+// component mask per slot. Live entities always fill slots [0, size()) (destroy moves the last entity
+// into the hole), so systems walk the arrays front to back with no pointer chasing. Slots are not
+// stable; handles are, through a slot map.
+class EntityStore
+{
+public:
+    // component arrays; an entry is meaningful only if its bit is set in mask
+    std::vector<unsigned char> mask;
+    std::vector<Transform>     transform;
+    std::vector<Velocity>      velocity;
+    std::vector<Collider>      collider;
+    std::vector<Sprite>        sprite;
+
+    EntityStore();
+    // adds an entity with the given component bits, its components zeroed
+    Entity        create(unsigned char components);
+    void          destroy(Entity entity);
+    void          clear();
+    void          reserve(std::size_t count);
+    bool          alive(Entity entity) const;
+    // slot of a live entity (no_slot for a handle that is not alive), and the entity in a slot
+    std::size_t   slot(Entity entity) const;
+    Entity        entity_at(std::size_t slot) const;
+    std::size_t   size() const;
+    // changes on every create and destroy, so systems can tell when cached layouts went stale
+    std::uint64_t version() const;
+    // moves the entity of slot order[i] to slot i for every i, keeping handles valid; order is a permutation of [0, size())
+    void          reorder(const std::vector<unsigned int>& order);
+private:
+    std::vector<Entity>        entities_;    // slot -> entity
+    std::vector<std::uint32_t> slots_;       // entity index -> slot, no_entity when free
+    std::vector<std::uint32_t> generations_; // entity index -> generation of its current (or next) entity
+    std::vector<std::uint32_t> free_;        // free entity indices
+    std::uint64_t              version_;
+    // reorder buffers, kept to avoid reallocating every step
+    std::vector<unsigned char> spare_mask_;
+    std::vector<Transform>     spare_transform_;
+    std::vector<Velocity>      spare_velocity_;
+    std::vector<Collider>      spare_collider_;
+    std::vector<Sprite>        spare_sprite_;
+    std::vector<Entity>        spare_entities_;
+
+    // frees the index of a live entity and moves its generation on
+    void          release_index(Entity entity);
+};
+
+#endif
\ No newline at end of file
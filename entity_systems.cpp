@@ -0,0 +1,274 @@
+#include "entity_systems.h"
+
+#include <algorithm>
+#include <cmath>
+
+constexpr unsigned char moving = component_transform | component_velocity;
+constexpr unsigned char colliding = component_transform | component_collider;
+
+// moving circles are sorted into the grid, everything else with a collider is a static box
+static bool is_circle(const EntityStore& store, const std::size_t slot)
+{
+    return (store.mask[slot] & (moving | colliding)) == (moving | colliding) && store.collider[slot].shape == collider_circle;
+}
+
+static bool is_box(const EntityStore& store, const std::size_t slot)
+{
+    return (store.mask[slot] & colliding) == colliding && store.collider[slot].shape == collider_box;
+}
+
+// pushes two overlapping circles apart and, if they are closing in, swaps their speeds along the contact normal (equal masses)
+static bool collide_pair(glm::vec2& position_a, glm::vec2& velocity_a, const float radius_a, glm::vec2& position_b, glm::vec2& velocity_b, const float radius_b)
+{
+    const glm::vec2 difference = position_b - position_a;
+    const float reach = radius_a + radius_b;
+    const float distance_squared = glm::dot(difference, difference);
+    if (distance_squared >= reach * reach)
+        return false;
+    // circles on the same spot separate along x
+    const float distance = std::sqrt(distance_squared);
+    const glm::vec2 normal = distance > 0.0f ? difference / distance : glm::vec2(1.0f, 0.0f);
+    const glm::vec2 push = normal * ((reach - distance) * 0.5f);
+    position_a -= push;
+    position_b += push;
+    const float approach = glm::dot(velocity_a - velocity_b, normal);
+    if (approach > 0.0f)
+    {
+        velocity_a -= normal * approach;
+        velocity_b += normal * approach;
+    }
+    return true;
+}
+
+// pushes a circle out of a box and reflects its velocity off the face it hit
+static bool collide_box(glm::vec2& position, glm::vec2& velocity, const float radius, const glm::vec2 box_min, const glm::vec2 box_max)
+{
+    const glm::vec2 closest = glm::clamp(position, box_min, box_max);
+    const glm::vec2 difference = position - closest;
+    const float distance_squared = glm::dot(difference, difference);
+    if (distance_squared >= radius * radius)
+        return false;
+    glm::vec2 normal;
+    if (distance_squared > 0.0f)
+    {
+        const float distance = std::sqrt(distance_squared);
+        normal = difference / distance;
+        position += normal * (radius - distance);
+    }
+    else
+    {
+        // center inside the box: leave through the nearest face
+        const float left = position.x - box_min.x, right = box_max.x - position.x;
+        const float top = position.y - box_min.y, bottom = box_max.y - position.y;
+        const float nearest = std::min(std::min(left, right), std::min(top, bottom));
+        if (nearest == left)
+            normal = glm::vec2(-1.0f, 0.0f);
+        else if (nearest == right)
+            normal = glm::vec2(1.0f, 0.0f);
+        else if (nearest == top)
+            normal = glm::vec2(0.0f, -1.0f);
+        else
+            normal = glm::vec2(0.0f, 1.0f);
+        position += normal * (nearest + radius);
+    }
+    const float into = glm::dot(velocity, normal);
+    if (into < 0.0f)
+        velocity -= normal * (2.0f * into);
+    return true;
+}
+
+void movement_system(EntityStore& store, const float dt, const glm::vec2 bounds)
+{
+    for (std::size_t i = 0; i < store.size(); i++)
+    {
+        if ((store.mask[i] & moving) != moving)
+            continue;
+        glm::vec2& position = store.transform[i].position;
+        glm::vec2& velocity = store.velocity[i].value;
+        const glm::vec2 half = store.transform[i].size * 0.5f;
+        store.transform[i].previous_position = position;
+        position += velocity * dt;
+        if (position.x < half.x)
+        {
+            position.x = half.x;
+            velocity.x = std::abs(velocity.x);
+        }
+        else if (position.x > bounds.x - half.x)
+        {
+            position.x = bounds.x - half.x;
+            velocity.x = -std::abs(velocity.x);
+        }
+        if (position.y < half.y)
+        {
+            position.y = half.y;
+            velocity.y = std::abs(velocity.y);
+        }
+        else if (position.y > bounds.y - half.y)
+        {
+            position.y = bounds.y - half.y;
+            velocity.y = -std::abs(velocity.y);
+        }
+    }
+}
+
+CollisionSystem::CollisionSystem()
+    : tested_pairs(0), contacts(0), cell_size_(0.0f), columns_(0), rows_(0), bounds_(0.0f), box_version_(0), box_grid_dirty_(true)
+{
+
+}
+
+void CollisionSystem::update(EntityStore& store, const glm::vec2 bounds)
+{
+    // the grid follows the largest circle and the bounds
+    float largest = 0.5f;
+    for (std::size_t i = 0; i < store.size(); i++)
+        if (is_circle(store, i))
+            largest = std::max(largest, store.collider[i].radius);
+    if (largest * 2.0f != this->cell_size_ || bounds != this->bounds_)
+        this->resize_grid(largest * 2.0f, bounds);
+    if (this->box_grid_dirty_ || store.version() != this->box_version_)
+        this->build_box_grid(store);
+
+    this->sort_circles(store);
+    this->tested_pairs = 0;
+    this->contacts = 0;
+    this->collide_circles(store);
+    this->collide_boxes(store);
+}
+
+void CollisionSystem::resize_grid(const float cell_size, const glm::vec2 bounds)
+{
+    this->cell_size_ = cell_size;
+    this->bounds_ = bounds;
+    this->columns_ = std::max(1u, static_cast<unsigned int>(std::ceil(bounds.x / cell_size)));
+    this->rows_ = std::max(1u, static_cast<unsigned int>(std::ceil(bounds.y / cell_size)));
+    this->box_grid_dirty_ = true;
+}
+
+void CollisionSystem::build_box_grid(const EntityStore& store)
+{
+    this->boxes_.clear();
+    for (std::size_t i = 0; i < store.size(); i++)
+        if (is_box(store, i))
+            this->boxes_.push_back({ store.transform[i].position - store.transform[i].size * 0.5f, store.transform[i].position + store.transform[i].size * 0.5f });
+
+    // counting sort of (cell, box) entries, each box in every cell it touches plus one cell of margin
+    const unsigned int cells = this->columns_ * this->rows_;
+    this->box_start_.assign(cells + 1, 0);
+    const auto for_each_cell = [this](const Box& box, auto&& visit) {
+        const float margin = this->cell_size_;
+        const int first_x = std::max(0, static_cast<int>((box.min.x - margin) / this->cell_size_));
+        const int first_y = std::max(0, static_cast<int>((box.min.y - margin) / this->cell_size_));
+        const int last_x = std::min(static_cast<int>(this->columns_) - 1, static_cast<int>((box.max.x + margin) / this->cell_size_));
+        const int last_y = std::min(static_cast<int>(this->rows_) - 1, static_cast<int>((box.max.y + margin) / this->cell_size_));
+        for (int y = first_y; y <= last_y; y++)
+            for (int x = first_x; x <= last_x; x++)
+                visit(static_cast<unsigned int>(y) * this->columns_ + static_cast<unsigned int>(x));
+    };
+    for (const Box& box : this->boxes_)
+        for_each_cell(box, [this](const unsigned int cell) { this->box_start_[cell + 1]++; });
+    for (unsigned int cell = 0; cell < cells; cell++)
+        this->box_start_[cell + 1] += this->box_start_[cell];
+    this->box_index_.resize(this->box_start_[cells]);
+    std::vector<unsigned int> cursor(this->box_start_.begin(), this->box_start_.end() - 1);
+    for (unsigned int i = 0; i < this->boxes_.size(); i++)
+        for_each_cell(this->boxes_[i], [&](const unsigned int cell) { this->box_index_[cursor[cell]++] = i; });
+    this->box_cells_.clear();
+    for (unsigned int cell = 0; cell < cells; cell++)
+        if (this->box_start_[cell] != this->box_start_[cell + 1])
+            this->box_cells_.push_back(cell);
+
+    this->box_version_ = store.version();
+    this->box_grid_dirty_ = false;
+}
+
+std::size_t CollisionSystem::sort_circles(EntityStore& store)
+{
+    // counting sort of the circles by cell; the other entities keep their order behind them
+    const unsigned int cells = this->columns_ * this->rows_;
+    const std::size_t count = store.size();
+    this->cell_start_.assign(cells + 1, 0);
+    this->circle_cell_.resize(count);
+    const float scale = 1.0f / this->cell_size_;
+    std::size_t circles = 0;
+    for (std::size_t i = 0; i < count; i++)
+    {
+        if (!is_circle(store, i))
+        {
+            this->circle_cell_[i] = cells;
+            continue;
+        }
+        const glm::vec2 position = store.transform[i].position;
+        const unsigned int x = std::min(this->columns_ - 1, static_cast<unsigned int>(std::max(0.0f, position.x * scale)));
+        const unsigned int y = std::min(this->rows_ - 1, static_cast<unsigned int>(std::max(0.0f, position.y * scale)));
+        this->circle_cell_[i] = y * this->columns_ + x;
+        this->cell_start_[this->circle_cell_[i] + 1]++;
+        circles++;
+    }
+    for (unsigned int cell = 0; cell < cells; cell++)
+        this->cell_start_[cell + 1] += this->cell_start_[cell];
+
+    this->cell_cursor_.assign(this->cell_start_.begin(), this->cell_start_.end() - 1);
+    this->order_.resize(count);
+    unsigned int rest = static_cast<unsigned int>(circles);
+    for (std::size_t i = 0; i < count; i++)
+    {
+        const unsigned int cell = this->circle_cell_[i];
+        this->order_[cell < cells ? this->cell_cursor_[cell]++ : rest++] = static_cast<unsigned int>(i);
+    }
+    store.reorder(this->order_);
+    return circles;
+}
+
+void CollisionSystem::collide_circles(EntityStore& store)
+{
+    // each pair of cells once: the cell with itself and the cell to its right, then with the three cells below.
+    // Cells of a row are contiguous in slot order, so both are a single run of circles
+    Transform* transform = store.transform.data();
+    Velocity* velocity = store.velocity.data();
+    const Collider* collider = store.collider.data();
+    const auto collide = [&](const unsigned int a, const unsigned int b) {
+        return collide_pair(transform[a].position, velocity[a].value, collider[a].radius, transform[b].position, velocity[b].value, collider[b].radius);
+    };
+    for (unsigned int y = 0; y < this->rows_; y++)
+    {
+        const unsigned int* row = &this->cell_start_[y * this->columns_];
+        const unsigned int* below = y + 1 < this->rows_ ? row + this->columns_ : nullptr;
+        for (unsigned int x = 0; x < this->columns_; x++)
+        {
+            const unsigned int first = row[x], last = row[x + 1];
+            if (first == last)
+                continue;
+            const unsigned int right_last = x + 1 < this->columns_ ? row[x + 2] : last;
+            for (unsigned int a = first; a < last; a++)
+                for (unsigned int b = a + 1; b < right_last; b++)
+                    this->contacts += collide(a, b);
+            this->tested_pairs += (last - first) * (last - first - 1) / 2 + (last - first) * (right_last - last);
+            if (below == nullptr)
+                continue;
+
+            const unsigned int below_first = below[x > 0 ? x - 1 : 0], below_last = below[std::min(x + 2, this->columns_)];
+            for (unsigned int a = first; a < last; a++)
+                for (unsigned int b = below_first; b < below_last; b++)
+                    this->contacts += collide(a, b);
+            this->tested_pairs += (last - first) * (below_last - below_first);
+        }
+    }
+}
+
+void CollisionSystem::collide_boxes(EntityStore& store)
+{
+    for (const unsigned int cell : this->box_cells_)
+    {
+        const unsigned int first_box = this->box_start_[cell], last_box = this->box_start_[cell + 1];
+        for (unsigned int i = this->cell_start_[cell]; i < this->cell_start_[cell + 1]; i++)
+        {
+            for (unsigned int b = first_box; b < last_box; b++)
+            {
+                const Box& box = this->boxes_[this->box_index_[b]];
+                this->contacts += collide_box(store.transform[i].position, store.velocity[i].value, store.collider[i].radius, box.min, box.max);
+            }
+        }
+        this->tested_pairs += (this->cell_start_[cell + 1] - this->cell_start_[cell]) * (last_box - first_box);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,56 @@
+#ifndef ENTITY_SYSTEMS_H
+#define ENTITY_SYSTEMS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "entity_store.h"
+
+// Systems over an EntityStore. Each walks the packed component arrays front to back and touches only
+// the entities whose mask has the components it needs. None of them needs a GL context (see draw_system.h).
+
+// moves every entity with a transform and a velocity through dt, bouncing it off the walls of [0, bounds];
+// the position it started from is kept in previous_position
+void movement_system(EntityStore& store, float dt, glm::vec2 bounds);
+
+// Resolves contacts between moving circles and against static boxes. Every update counting-sorts the
+// circles into a uniform grid (cells twice the largest radius), linear in circles plus cells, and
+// reorders the store so they sit in cell order; a circle then only meets the circles of its own and the
+// neighbouring cells and the boxes registered in its cell. The box grid is rebuilt when entities are
+// created or destroyed; boxes are not expected to move.
+class CollisionSystem
+{
+public:
+    // narrowphase work of the last update
+    std::size_t tested_pairs; // circle pairs and circle-box pairs the grid made candidates
+    std::size_t contacts;     // of those, the ones that touched
+
+    CollisionSystem();
+    void update(EntityStore& store, glm::vec2 bounds);
+private:
+    struct Box
+    {
+        glm::vec2 min, max;
+    };
+    float                     cell_size_;
+    unsigned int              columns_, rows_;
+    glm::vec2                 bounds_;
+    std::uint64_t             box_version_; // store version the box grid was built for
+    bool                      box_grid_dirty_;
+    // circles of cell c are slots [cell_start_[c], cell_start_[c + 1]) after the reorder
+    std::vector<unsigned int> cell_start_, cell_cursor_, circle_cell_, order_;
+    // boxes overlapping (with a one cell margin) cell c are box_index_[box_start_[c] .. box_start_[c + 1])
+    std::vector<Box>          boxes_;
+    std::vector<unsigned int> box_start_, box_index_;
+    std::vector<unsigned int> box_cells_; // cells with at least one box
+
+    void resize_grid(float cell_size, glm::vec2 bounds);
+    void build_box_grid(const EntityStore& store);
+    // sorts the circles by cell into slots [0, circles); returns the number of circles
+    std::size_t sort_circles(EntityStore& store);
+    void collide_circles(EntityStore& store);
+    void collide_boxes(EntityStore& store);
+};
+
+#endif
\ No newline at end of file
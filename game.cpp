@@ -1,32 +1,82 @@
 #include "game.h"
 #include "ResourceManager.h"
 #include "sprite_renderer.h"
-#include "game_object.h"
-#include "ball_object.h"
+#include "draw_system.h"
+#include "load_profiler.h"
+#include "embedded_assets.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
 #include <iostream>
+#include <sstream>
 #include <GLFW/glfw3.h>
 
 // Game-related state data
 SpriteRenderer* renderer;
-GameObject* player1;
-GameObject* player2;
-BallObject* ball;
 
 using namespace std;
 
-// Defines a Collision typedef that represents collision data
-typedef std::tuple<bool, direction, glm::vec2> Collision; // <collision?, what direction?, difference vector center - closest point>
+// pre-decoded asset pack built with the asset packer; loose files are used when it is missing
+static const char* const asset_pack_file = "assets.pack";
+
+// Textures loaded from loose files
+struct GameTexture
+{
+    const char* file;
+    bool        alpha;
+    const char* name;
+};
+static const GameTexture game_textures[] = {
+    { "textures/mesa.jpg",   false, "background" },
+    { "textures/ball.png",   true,  "ball" },
+    { "textures/paddle.png", true,  "paddle" }
+};
+
+// all textures are drawn far below their source resolution, so they get mipmaps
+static TextureSettings game_texture_settings()
+{
+    TextureSettings settings;
+    settings.mipmaps = mipmaps_gpu;
+    return settings;
+}
+
+// keeps the current state on screen while the simulation does not step (no interpolation from an older step)
+static void hold_positions(Simulation& simulation)
+{
+    simulation.player1.previous_position = simulation.player1.position;
+    simulation.player2.previous_position = simulation.player2.position;
+    simulation.ball.previous_position = simulation.ball.position;
+}
 
 Game::Game(const unsigned int width, const unsigned int height)
-    : keys(), width(width), height(height)
+    : keys(), width(width), height(height), simulation(width, height), replaying(false), arena(width, height)
 {
 
 }
 
+void Game::preload()
+{
+    // the pack holds the textures already decoded, nothing to overlap
+    if (find_embedded_asset(asset_pack_file) || std::ifstream(asset_pack_file))
+        return;
+    for (const GameTexture& texture : game_textures)
+        ResourceManager::preload_texture(texture.file, texture.alpha, game_texture_settings());
+}
+
 void Game::init()
 {
+    this->load_start = std::chrono::steady_clock::now();
+
+    // textures beyond this budget are evicted when unused and reloaded on their next use
+    ResourceManager::set_texture_budget(texture_memory_budget);
+
+    // load shaders and textures from the pre-decoded asset pack, if one was built with the asset packer
+    const bool packed = ResourceManager::load_pack(asset_pack_file);
+
     // load shaders
-    ResourceManager::load_shader("shaders/sprite.vs", "shaders/sprite.frag", nullptr, "sprite");
+    if (!packed)
+        ResourceManager::load_shader("shaders/sprite.vs", "shaders/sprite.frag", nullptr, "sprite");
 
     // projection
     const glm::mat4 projection = glm::ortho(0.0f, static_cast<float>(this->width), static_cast<float>(this->height), 0.0f, -1.0f, 1.0f);
@@ -38,202 +88,190 @@ void Game::init()
     // set render-specific controls
     renderer = new SpriteRenderer(ResourceManager::get_shader("sprite"));
 
-    // load textures
-    ResourceManager::load_texture("textures/mesa.jpg", false, "background");
-    ResourceManager::load_texture("textures/ball.png", true, "ball");
-    ResourceManager::load_texture("textures/paddle.png", true, "paddle");
+    // declare textures: each one is decoded in the background on its first use (or taken from preload())
+    // and drawn as a placeholder until then
+    if (!packed)
+        for (const GameTexture& texture : game_textures)
+            ResourceManager::declare_texture(texture.file, texture.alpha, texture.name, game_texture_settings());
+}
 
-    // configure game object for player1
-    const glm::vec2 player1Pos = glm::vec2(0, this->height / 2.0f - player_size.y / 2.0f);
-    player1 = new GameObject(player1Pos, player_size, ResourceManager::get_texture("paddle"));
+void Game::report_loading() const
+{
+    // report where the load time went, the json is meant for tooling
+    const double loadTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - this->load_start).count();
+    LoadProfiler::print_report(std::cout, loadTime);
+    LoadProfiler::write_json("load_report.json", loadTime);
+}
 
-    // configure game object for player2
-    const glm::vec2 player2Pos = glm::vec2(this->width - player_size.x, this->height / 2.0f - player_size.y / 2.0f);
-    player2 = new GameObject(player2Pos, player_size, ResourceManager::get_texture("paddle"));
+SimulationInput Game::read_input() const
+{
+    SimulationInput input;
+    input.player1_up = this->keys[GLFW_KEY_W];
+    input.player1_down = this->keys[GLFW_KEY_S];
+    input.player2_up = this->keys[GLFW_KEY_UP];
+    input.player2_down = this->keys[GLFW_KEY_DOWN];
+    input.launch = this->keys[GLFW_KEY_SPACE];
+    return input;
+}
+
+void Game::apply_bots(const float dt, SimulationInput& input)
+{
+    for (AiController& bot : this->bots)
+    {
+        // the bot alone moves its paddle
+        if (bot.player() == 1)
+            input.player1_up = input.player1_down = false;
+        else
+            input.player2_up = input.player2_down = false;
+        bot.control(this->simulation, dt, input);
+    }
+}
+
+void Game::add_bot(const unsigned int player, const float skill)
+{
+    this->bots.erase(std::remove_if(this->bots.begin(), this->bots.end(), [player](const AiController& bot) { return bot.player() == player; }), this->bots.end());
+    this->bots.emplace_back(player, ai_settings(skill), static_cast<unsigned int>(this->bots.size() + 1));
+}
+
+bool Game::record(const char* file, const float dt)
+{
+    return this->recorder.open(file, this->simulation, dt);
+}
 
-    // configure ball object
-    const glm::vec2 ballPos = player1Pos + glm::vec2(player_size.x, player_size.y / 2 - ball_radius);
-    ball = new BallObject(ballPos, ball_radius, initial_ball_velocity, ResourceManager::get_texture("ball"));
+bool Game::play(const char* file)
+{
+    if (!this->replay.load(file) || !this->replay.seek(this->simulation, this->replay.first_tick()))
+        return false;
+    this->replaying = true;
+    return true;
+}
+
+bool Game::connect(const unsigned short local_port, const char* peer_host, const unsigned short peer_port, const unsigned int local_player,
+                   const unsigned int input_delay, const float dt)
+{
+    return this->netplay.start(local_port, peer_host, peer_port, local_player, input_delay, dt);
 }
 
-void Game::update(float dt)
+void Game::reload_textures()
 {
-    // update objects
-    ball->move(dt, this->width, this->height);
+    for (const GameTexture& texture : game_textures)
+        ResourceManager::stream_texture(texture.file, texture.alpha, texture.name);
+}
 
-    // check for collisions
-    this->do_collisions(ball, player1);
-    this->do_collisions(ball, player2);
+void Game::start_arena(const unsigned int balls)
+{
+    const float radius = std::max(1.0f, std::min(ball_radius, std::sqrt(0.2f * this->width * this->height / (3.14159265f * std::max(balls, 1u)))));
+    this->arena.populate(balls, radius);
+}
 
-    // check loss condition
-    if (ball->position.x <= 0.0f) // Did the ball pass player1?
+std::string Game::net_status() const
+{
+    if (!this->netplay.is_active())
+        return std::string();
+    const NetStats& stats = this->netplay.stats;
+    std::ostringstream status;
+    status << "PingPong - player " << this->netplay.local_player();
+    if (stats.same_player)
     {
-        this->reset_player();
-        ball->reset(player2->position + glm::vec2(-ball_radius * 2, player_size.y / 2 - ball_radius), initial_ball_velocity);
+        status << " - the peer plays this paddle too, no connection";
+        return status.str();
     }
-    if (ball->position.x + ball->radius >= width) // Did the ball pass player2?
+    if (!stats.connected)
     {
-        this->reset_player();
-        ball->reset(player1->position + glm::vec2(player_size.x, player_size.y / 2 - ball_radius), initial_ball_velocity);
+        status << " - waiting for the peer";
+        return status.str();
     }
+    status << " - ping " << static_cast<int>(stats.ping + 0.5f) << " ms, delay " << this->netplay.input_delay() << ", predicting "
+           << stats.prediction_ticks << ", rollback " << stats.rollback_ticks << " (" << stats.rollbacks << " total), stalls " << stats.stalls;
+    if (stats.desyncs > 0)
+        status << ", DESYNC x" << stats.desyncs;
+    return status.str();
 }
 
-void Game::process_input(float dt)
+void Game::step(const float dt)
 {
-    const float velocity = player_velocity * dt;
-
-    // player1 movement
-    if (this->keys[GLFW_KEY_W]) // Up
+    if (this->arena.count() > 0)
     {
-        if (player1->position.y >= 0.0f)
-        {
-            player1->position.y -= velocity;
-            if (ball->stuck && ball->position.x <= this->width / 2)
-                ball->position.y -= velocity;
-        }
+        this->arena.step(dt);
+        return;
     }
-    if (this->keys[GLFW_KEY_S]) // Down
+    if (this->netplay.is_active())
     {
-        if (player1->position.y <= this->height - player1->size.y)
+        // either set of keys drives the local paddle
+        SimulationInput input = this->read_input();
+        input.player1_up = input.player2_up = input.player1_up || input.player2_up;
+        input.player1_down = input.player2_down = input.player1_down || input.player2_down;
+        // unless a bot plays it, after the merge so no key reaches it; only the local paddle is ours to play
+        const unsigned int local_player = this->netplay.local_player();
+        const auto bot = std::find_if(this->bots.begin(), this->bots.end(), [local_player](const AiController& b) { return b.player() == local_player; });
+        const AiController before = bot != this->bots.end() ? *bot : AiController();
+        if (bot != this->bots.end())
         {
-            player1->position.y += velocity;
-            if (ball->stuck && ball->position.x <= this->width / 2)
-                ball->position.y += velocity;
+            input.player1_up = input.player1_down = input.player2_up = input.player2_down = false;
+            bot->control(this->simulation, dt, input);
         }
-    }
-
-    // player2 movement
-    if (this->keys[GLFW_KEY_UP]) // up
-    {
-        if (player2->position.y >= 0.0f)
+        if (!this->netplay.advance(this->simulation, input))
         {
-            player2->position.y -= velocity;
-            if (ball->stuck && ball->position.x >= this->width / 2)
-                ball->position.y -= velocity;
+            // the tick was skipped, so the bot's timers did not run either
+            if (bot != this->bots.end())
+                *bot = before;
+            hold_positions(this->simulation);
         }
+        return;
     }
-    if (this->keys[GLFW_KEY_DOWN]) // down
+    if (!this->replaying)
     {
-        if (player2->position.y <= this->height - player2->size.y)
-        {
-            player2->position.y += velocity;
-            if (ball->stuck && ball->position.x >= this->width / 2)
-                ball->position.y += velocity;
-        }
+        SimulationInput input = this->read_input();
+        this->apply_bots(dt, input);
+        this->recorder.record(this->simulation, input);
+        this->simulation.step(input, dt);
+        return;
     }
 
-    // defines that the ball can move
-    if (this->keys[GLFW_KEY_SPACE])
-        ball->stuck = false;
+    // playback, with the recorded step length; the last state stays on screen once the recording ends
+    Simulation& state = this->simulation;
+    if (state.tick >= this->replay.end_tick())
+    {
+        hold_positions(state);
+        return;
+    }
+    state.step(this->replay.input(state.tick), this->replay.step_length);
+    if (!this->replay.verify(state))
+        std::cout << "ERROR::REPLAY: Playback diverged from the recording at tick " << state.tick << std::endl;
 }
 
-void Game::render()
+void Game::render(const float alpha)
 {
+    const Simulation& state = this->simulation;
+
     // draw background
     renderer->draw_sprite(ResourceManager::get_texture("background"), glm::vec2(0.0f, 0.0f), glm::vec2(this->width, this->height), 0.0f);
 
+    // arena mode: obstacles and balls, interpolated like the match
+    if (this->arena.count() > 0)
+    {
+        // in arena_texture order; copies, a default Texture2D would create a GL texture
+        const Texture2D arena_textures[arena_texture_count] = { ResourceManager::get_texture("ball"), ResourceManager::get_texture("paddle") };
+        draw_system(this->arena.entities, *renderer, arena_textures, alpha);
+        return;
+    }
+
     // draw player1
-    player1->draw(*renderer);
+    renderer->draw_sprite(ResourceManager::get_texture("paddle"), state.player1.render_position(alpha), state.player1.size, state.player1.rotation, state.player1.color);
 
     // draw player2
-    player2->draw(*renderer);
+    renderer->draw_sprite(ResourceManager::get_texture("paddle"), state.player2.render_position(alpha), state.player2.size, state.player2.rotation, state.player2.color);
 
     // draw ball
-    ball->draw(*renderer);
-}
-
-void Game::reset_player()
-{
-    // reset player1 stats
-    player1->size = player_size;
-    player1->position = glm::vec2(0, this->height / 2.0f - player_size.y / 2.0f);
-
-    // reset player2 stats
-    player2->size = player_size;
-    player2->position = glm::vec2(this->width - player_size.x, this->height / 2.0f - player_size.y / 2.0f);
-}
-
-// collision detection
-bool check_collision(GameObject& one, GameObject& two);
-Collision check_collision(BallObject& one, GameObject& two);
-direction vector_direction(glm::vec2 closest);
-
-void Game::do_collisions(BallObject* ball, GameObject* player)
-{
-    Collision result = check_collision(*ball, *player);
-    if (!ball->stuck && std::get<0>(result)) // check collisions for player pad (unless stuck)
-    {
-        // check where it hit the board, and change velocity based on where it hit the board
-        const float center_board = player->position.y + player->size.y / 2.0f; // Calculate the coordinate that represents the center of the racket.
-        const float distance = (ball->position.y + ball->radius) - center_board;
-        const float percentage = distance / (player->size.y / 2.0f);
-        
-        // then move accordingly
-        constexpr float strength = 2.0f;
-        const glm::vec2 old_velocity = ball->velocity;
-        ball->velocity.y = initial_ball_velocity.y * percentage * strength;
-        ball->velocity = glm::normalize(ball->velocity) * glm::length(old_velocity); // keep speed consistent over both axes (multiply by length of old velocity, so total strength is not changed)
-        
-        // fix sticky paddle
-        if (ball->position.x < this->width / 2) {
-            ball->velocity.x = 1.0f * abs(ball->velocity.x);
-        }
-        else {
-            ball->velocity.x = -1.0f * abs(ball->velocity.x);
-        }
-    }
-}
+    renderer->draw_sprite(ResourceManager::get_texture("ball"), state.ball.render_position(alpha), state.ball.size, state.ball.rotation, state.ball.color);
 
-bool check_collision(const GameObject& one, const GameObject& two) // AABB - AABB collision
-{
-    // collision x-axis?
-    const bool collision_x = one.position.x + one.size.x >= two.position.x && two.position.x + two.size.x >= one.position.x;
-    // collision y-axis?
-    const bool collision_y = one.position.y + one.size.y >= two.position.y && two.position.y + two.size.y >= one.position.y;
-    // collision only if on both axes
-    return collision_x && collision_y;
-}
-
-Collision check_collision(BallObject& one, GameObject& two) // AABB - Circle collision
-{
-    // get center point circle first 
-    glm::vec2 center(one.position + one.radius);
-    // calculate AABB info (center, half-extents)
-    glm::vec2 aabb_half_extents(two.size.x / 2.0f, two.size.y / 2.0f);
-    glm::vec2 aabb_center(two.position.x + aabb_half_extents.x, two.position.y + aabb_half_extents.y);
-    // get difference vector between both centers
-    glm::vec2 difference = center - aabb_center;
-    glm::vec2 clamped = glm::clamp(difference, -aabb_half_extents, aabb_half_extents);
-    // now that we know the clamped values, add this to AABB_center and we get the value of box closest to circle
-    glm::vec2 closest = aabb_center + clamped;
-    // now retrieve vector between center circle and closest point AABB and check if length < radius
-    difference = closest - center;
-
-    if (glm::length(difference) <= one.radius)
-        return std::make_tuple(true, vector_direction(difference), difference);
-    else
-        return std::make_tuple(false, up, glm::vec2(0.0f, 0.0f));
-}
-
-// calculates which direction a vector is facing (N,E,S or W)
-direction vector_direction(glm::vec2 closest)
-{
-    constexpr glm::vec2 compass[] = {
-			  glm::vec2(0.0f, 1.0f),	// up
-			  glm::vec2(1.0f, 0.0f),	// right
-			  glm::vec2(0.0f, -1.0f),	// down
-			  glm::vec2(-1.0f, 0.0f)	// left
-    };
-    float max = 0.0f;
-    unsigned int best_match = -1;
-    for (unsigned int i = 0; i < 4; i++)
+    // net play overlay: round trip (2 px per ms), ticks predicted and ticks re-simulated by the last rollback (8 px per tick)
+    if (this->netplay.is_active())
     {
-        float dot_product = glm::dot(glm::normalize(closest), compass[i]);
-        if (dot_product > max)
-        {
-            max = dot_product;
-            best_match = i;
-        }
+        const NetStats& stats = this->netplay.stats;
+        const Texture2D bar = ResourceManager::get_texture("paddle");
+        renderer->draw_sprite(bar, glm::vec2(10.0f, 10.0f), glm::vec2(std::min(stats.ping * 2.0f, 400.0f) + 2.0f, 6.0f), 0.0f, glm::vec3(0.2f, 0.9f, 0.2f));
+        renderer->draw_sprite(bar, glm::vec2(10.0f, 20.0f), glm::vec2(stats.prediction_ticks * 8.0f + 2.0f, 6.0f), 0.0f, glm::vec3(0.9f, 0.9f, 0.2f));
+        renderer->draw_sprite(bar, glm::vec2(10.0f, 30.0f), glm::vec2(stats.rollback_ticks * 8.0f + 2.0f, 6.0f), 0.0f, glm::vec3(0.9f, 0.2f, 0.2f));
     }
-    return (direction)best_match;
 }
\ No newline at end of file
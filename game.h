@@ -1,28 +1,22 @@
 #ifndef GAME_H
 #define GAME_H
 
+#include <chrono>
+#include "deterministic_math.h"
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
-#include "game_object.h"
-#include "ball_object.h"
-
-// Represents the four possible (collision) directions
-enum direction {
-    up,
-    right,
-    down,
-    left
-};
+#include <string>
+#include <vector>
+
+#include "ai_controller.h"
+#include "arena.h"
+#include "replay.h"
+#include "rollback_session.h"
+#include "simulation.h"
 
-// Initial size of the player paddle
-constexpr glm::vec2 player_size(20.0f, 100.0f);
-// Initial velocity of the player paddle
-constexpr float player_velocity(1000.0f);
-// Initial velocity of the ball
-constexpr glm::vec2 initial_ball_velocity(1500.0f, -150.0f);
-// radius of the ball object
-constexpr float ball_radius = 12.5f;
+// GPU memory budget for file-loaded textures; least recently used ones are evicted beyond it
+constexpr size_t texture_memory_budget = 256 * 1024 * 1024;
 
 // Game holds all game-related state and functionality.
 // Combines all game-related data into a single class for
@@ -33,21 +27,54 @@ public:
     // game state
     bool                    keys[1024];
     unsigned int            width, height;
+    // rules and state of the match, stepped with the keys as input
+    Simulation              simulation;
+    // recording of every step, and a recording played back instead of the keys
+    ReplayWriter            recorder;
+    Replay                  replay;
+    bool                    replaying;
+    // rollback play against another instance over UDP
+    RollbackSession         netplay;
+    // arena mode: many balls and obstacles instead of the match, while it holds any ball
+    Arena                   arena;
+    // computer players, their paddles ignore the keys
+    std::vector<AiController> bots;
+    // when init started loading, for the load report
+    std::chrono::steady_clock::time_point load_start;
 
     // constructor/destructor
     Game(unsigned int width, unsigned int height);
 
+    // start decoding the textures on worker threads; needs no GL context, so it can run before the window exists
+    void preload();
     // initialize game state (load all shaders/textures/levels)
     void init();
+    // prints the per-asset load report and writes load_report.json; call once the declared textures have loaded
+    void report_loading() const;
+    // records the match from now on into a replay file; returns false if it cannot be created
+    bool record(const char* file, float dt);
+    // plays a replay file instead of reading the keys; returns false if it cannot be loaded
+    bool play(const char* file);
+    // plays against the instance at peer_host:peer_port, the keys driving paddle local_player; returns false if the socket fails
+    bool connect(unsigned short local_port, const char* peer_host, unsigned short peer_port, unsigned int local_player, unsigned int input_delay, float dt);
+    // lets the computer play paddle player (1 or 2) at a skill from 0 to 1
+    void add_bot(unsigned int player, float skill);
+    // reloads the loose texture files in the background, e.g. after editing them; the old images stay on screen until then
+    void reload_textures();
+    // switches to arena mode with that many balls, sized to cover a fifth of the screen at most
+    void start_arena(unsigned int balls);
+    // one line of network figures for the window title, empty without net play
+    std::string net_status() const;
 
     // game loop
-    void process_input(float dt);
-    void update(float dt);
-    void render();
-    void do_collisions(BallObject* ball, GameObject* player);
-
-    // reset
-    void reset_player();
+    // maps the pressed keys to simulation input
+    SimulationInput read_input() const;
+    // lets the bots set their paddles (and launch), replacing the keys of those paddles
+    void apply_bots(float dt, SimulationInput& input);
+    // advances the simulation by one fixed step
+    void step(float dt);
+    // draws the objects between their previous and current positions, alpha being the fraction of a step left unsimulated
+    void render(float alpha = 1.0f);
 };
 
 #endif
\ No newline at end of file
@@ -10,12 +10,12 @@
 
 
 GameObject::GameObject()
-    : position(0.0f, 0.0f), size(1.0f, 1.0f), velocity(0.0f), color(1.0f), rotation(0.0f), sprite() { }
+    : position(0.0f, 0.0f), size(1.0f, 1.0f), velocity(0.0f), previous_position(0.0f, 0.0f), color(1.0f), rotation(0.0f) { }
 
-GameObject::GameObject(glm::vec2 pos, glm::vec2 size, Texture2D sprite, glm::vec3 color, glm::vec2 velocity)
-    : position(pos), size(size), velocity(velocity), color(color), rotation(0.0f), sprite(sprite) { }
+GameObject::GameObject(glm::vec2 pos, glm::vec2 size, glm::vec3 color, glm::vec2 velocity)
+    : position(pos), size(size), velocity(velocity), previous_position(pos), color(color), rotation(0.0f) { }
 
-void GameObject::draw(SpriteRenderer& renderer)
+glm::vec2 GameObject::render_position(const float alpha) const
 {
-    renderer.draw_sprite(this->sprite, this->position, this->size, this->rotation, this->color);
+    return glm::mix(this->previous_position, this->position, alpha);
 }
\ No newline at end of file
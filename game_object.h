@@ -1,29 +1,27 @@
 #ifndef GAME_OBJECT_H
 #define GAME_OBJECT_H
 
+#include "deterministic_math.h"
 #include <glm/glm.hpp>
 
-#include "texture.h"
-#include "sprite_renderer.h"
-
 
 // Container object for holding all state relevant for a single
 // game object entity. Each object in the game likely needs the
-// minimal of state as described within GameObject.
+// minimal of state as described within GameObject. It holds no
+// render state, so the simulation can use it without a GL context.
 class GameObject
 {
 public:
     // object state
     glm::vec2   position, size, velocity;
+    glm::vec2   previous_position; // position at the start of the current simulation step, rendering interpolates from it
     glm::vec3   color;
     float       rotation;
-    // render state
-    Texture2D   sprite;
     // constructor(s)
     GameObject();
-    GameObject(glm::vec2 pos, glm::vec2 size, Texture2D sprite, glm::vec3 color = glm::vec3(1.0f), glm::vec2 velocity = glm::vec2(0.0f, 0.0f));
-    // draw sprite
-    virtual void draw(SpriteRenderer& renderer);
+    GameObject(glm::vec2 pos, glm::vec2 size, glm::vec3 color = glm::vec3(1.0f), glm::vec2 velocity = glm::vec2(0.0f, 0.0f));
+    // position to draw at, alpha interpolating between the previous and the current position
+    glm::vec2 render_position(float alpha) const;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,187 @@
+#include "image_arena.h"
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+
+// Precedes every block handed out; keeps the returned pointer 16-byte aligned
+struct alignas(16) BlockHeader
+{
+    std::uint32_t size_class; // the block holds 2^size_class bytes, header included
+    std::uint32_t owner;      // id of the thread that allocated it last
+    BlockHeader*  next;       // next free block of the same class while cached
+};
+
+constexpr unsigned int min_size_class = 6;
+constexpr unsigned int size_class_count = 48;
+// cached memory beyond these limits goes back to the heap
+constexpr std::size_t  thread_cache_limit = 64u << 20;
+constexpr std::size_t  shared_cache_limit = 128u << 20;
+
+static std::atomic<std::uint32_t> next_thread_id(1);
+static std::atomic<std::size_t>   heap_allocations(0);
+
+// returns a list of free blocks to the heap
+static void release_blocks(BlockHeader*& head)
+{
+    while (head != nullptr)
+    {
+        BlockHeader* next = head->next;
+        std::free(head);
+        head = next;
+    }
+}
+
+// free blocks of one thread, used without locking
+struct ThreadArena
+{
+    std::uint32_t id;
+    BlockHeader*  free_blocks[size_class_count] = {};
+    std::size_t   cached_bytes = 0;
+
+    ThreadArena() : id(next_thread_id++) {}
+    ~ThreadArena();
+};
+static thread_local ThreadArena arena;
+// set once the thread's arena is destroyed; a plain bool outlives it, so frees from later destructors
+// (pool workers winding down, statics at exit) can still tell and go straight to the heap
+static thread_local bool arena_destroyed = false;
+
+ThreadArena::~ThreadArena()
+{
+    arena_destroyed = true;
+    for (BlockHeader*& head : free_blocks)
+        release_blocks(head);
+}
+
+// the calling thread's arena, nullptr once it has been destroyed
+static ThreadArena* thread_arena()
+{
+    return arena_destroyed ? nullptr : &arena;
+}
+
+// free blocks released by other threads than their owner
+static std::mutex   shared_mutex;
+static BlockHeader* shared_blocks[size_class_count] = {};
+static std::size_t  shared_bytes = 0;
+
+
+static unsigned int size_class_of(std::size_t bytes)
+{
+    unsigned int size_class = min_size_class;
+    while ((static_cast<std::size_t>(1) << size_class) < bytes)
+        size_class++;
+    return size_class;
+}
+
+static std::size_t size_class_bytes(unsigned int size_class)
+{
+    return static_cast<std::size_t>(1) << size_class;
+}
+
+void* image_arena_malloc(std::size_t size)
+{
+    const unsigned int size_class = size_class_of(size + sizeof(BlockHeader));
+    if (size_class >= size_class_count)
+        return nullptr;
+    ThreadArena* local = thread_arena();
+    // own cache first, then blocks other threads handed back, then the heap
+    BlockHeader* block = local != nullptr ? local->free_blocks[size_class] : nullptr;
+    if (block != nullptr)
+    {
+        local->free_blocks[size_class] = block->next;
+        local->cached_bytes -= size_class_bytes(size_class);
+    }
+    else if (local != nullptr)
+    {
+        std::lock_guard<std::mutex> lock(shared_mutex);
+        block = shared_blocks[size_class];
+        if (block != nullptr)
+        {
+            shared_blocks[size_class] = block->next;
+            shared_bytes -= size_class_bytes(size_class);
+        }
+    }
+    if (block == nullptr)
+    {
+        block = static_cast<BlockHeader*>(std::malloc(size_class_bytes(size_class)));
+        if (block == nullptr)
+            return nullptr;
+        block->size_class = size_class;
+        heap_allocations++;
+    }
+    // blocks of a thread past its arena belong to nobody and end up back on the heap
+    block->owner = local != nullptr ? local->id : 0;
+    return block + 1;
+}
+
+void* image_arena_realloc(void* memory, std::size_t size)
+{
+    if (memory == nullptr)
+        return image_arena_malloc(size);
+    BlockHeader* block = static_cast<BlockHeader*>(memory) - 1;
+    const std::size_t capacity = size_class_bytes(block->size_class) - sizeof(BlockHeader);
+    // stb grows its buffers by doubling, so most calls still fit the power-of-two block
+    if (size <= capacity)
+        return memory;
+    void* grown = image_arena_malloc(size);
+    if (grown == nullptr)
+        return nullptr;
+    std::memcpy(grown, memory, capacity);
+    image_arena_free(memory);
+    return grown;
+}
+
+void image_arena_free(void* memory)
+{
+    if (memory == nullptr)
+        return;
+    BlockHeader* block = static_cast<BlockHeader*>(memory) - 1;
+    const std::size_t bytes = size_class_bytes(block->size_class);
+    ThreadArena* local = thread_arena();
+    if (local == nullptr)
+    {
+        std::free(block);
+        return;
+    }
+    if (block->owner == local->id && local->cached_bytes + bytes <= thread_cache_limit)
+    {
+        block->next = local->free_blocks[block->size_class];
+        local->free_blocks[block->size_class] = block;
+        local->cached_bytes += bytes;
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(shared_mutex);
+        if (shared_bytes + bytes <= shared_cache_limit)
+        {
+            block->next = shared_blocks[block->size_class];
+            shared_blocks[block->size_class] = block;
+            shared_bytes += bytes;
+            return;
+        }
+    }
+    std::free(block);
+}
+
+void image_arena_trim()
+{
+    ThreadArena* local = thread_arena();
+    if (local != nullptr)
+    {
+        for (BlockHeader*& head : local->free_blocks)
+            release_blocks(head);
+        local->cached_bytes = 0;
+    }
+    std::lock_guard<std::mutex> lock(shared_mutex);
+    for (BlockHeader*& head : shared_blocks)
+        release_blocks(head);
+    shared_bytes = 0;
+}
+
+std::size_t image_arena_heap_allocations()
+{
+    return heap_allocations;
+}
\ No newline at end of file
@@ -0,0 +1,19 @@
+#ifndef IMAGE_ARENA_H
+#define IMAGE_ARENA_H
+
+#include <cstddef>
+
+
+// Recycling allocator behind stb_image (STBI_MALLOC/STBI_REALLOC/STBI_FREE). Freed blocks are kept in
+// power-of-two size classes, in a lock-free cache of the thread that allocated them or, when another
+// thread frees them (e.g. pixels uploaded on the GL thread), in a shared pool that thread takes them back
+// from. Once every thread has decoded its largest image, further decodes do not touch the heap.
+void*       image_arena_malloc(std::size_t size);
+void*       image_arena_realloc(void* block, std::size_t size);
+void        image_arena_free(void* block);
+// returns the blocks cached by the calling thread and the shared pool to the heap
+void        image_arena_trim();
+// number of blocks taken from the heap so far, by all threads
+std::size_t image_arena_heap_allocations();
+
+#endif
\ No newline at end of file
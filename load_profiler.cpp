@@ -0,0 +1,123 @@
+#include "load_profiler.h"
+#include "image_arena.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <vector>
+
+std::mutex                             LoadProfiler::mutex_;
+std::map<std::string, AssetLoadRecord> LoadProfiler::records_;
+
+static const char* const stage_names[stage_count] = { "io", "decode", "convert", "upload" };
+
+static double total_seconds(const AssetLoadRecord& record)
+{
+    double total = 0.0;
+    for (int stage = 0; stage < stage_count; stage++)
+        total += record.seconds[stage];
+    return total;
+}
+
+// JSON string literal with the characters that need escaping in file paths
+static std::string json_string(const std::string& text)
+{
+    std::string quoted = "\"";
+    for (const char c : text)
+    {
+        if (c == '"' || c == '\\')
+            quoted += '\\';
+        quoted += c;
+    }
+    return quoted + "\"";
+}
+
+void LoadProfiler::record(const std::string& asset, load_stage stage, double seconds, std::size_t bytes)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    AssetLoadRecord& record = records_[asset];
+    record.seconds[stage] += seconds;
+    record.bytes[stage] += bytes;
+}
+
+void LoadProfiler::print_report(std::ostream& out, double wall_seconds)
+{
+    std::vector<std::pair<std::string, AssetLoadRecord>> sorted;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        sorted.assign(records_.begin(), records_.end());
+    }
+    std::sort(sorted.begin(), sorted.end(), [](const std::pair<std::string, AssetLoadRecord>& a, const std::pair<std::string, AssetLoadRecord>& b)
+    {
+        return total_seconds(a.second) > total_seconds(b.second);
+    });
+
+    const std::ios::fmtflags flags = out.flags();
+    out << std::fixed << std::setprecision(2);
+    out << "Asset load report (" << wall_seconds * 1000.0 << " ms wall time)" << std::endl;
+    out << "  " << std::left << std::setw(28) << "asset" << std::right;
+    for (const char* name : stage_names)
+        out << std::setw(10) << name << " ms" << std::setw(10) << "KiB";
+    out << std::setw(10) << "total ms" << std::endl;
+    for (const auto& entry : sorted)
+    {
+        out << "  " << std::left << std::setw(28) << entry.first << std::right;
+        for (int stage = 0; stage < stage_count; stage++)
+            out << std::setw(13) << entry.second.seconds[stage] * 1000.0 << std::setw(10) << entry.second.bytes[stage] / 1024.0;
+        out << std::setw(10) << total_seconds(entry.second) * 1000.0 << std::endl;
+    }
+    // stays flat once the image arena recycles every decode buffer
+    out << "  image arena: " << image_arena_heap_allocations() << " heap blocks" << std::endl;
+    out.flags(flags);
+}
+
+bool LoadProfiler::write_json(const char* file, double wall_seconds)
+{
+    std::ofstream out(file, std::ios::trunc);
+    if (!out)
+        return false;
+    std::lock_guard<std::mutex> lock(mutex_);
+    AssetLoadRecord totals;
+    out << "{\n  \"wall_ms\": " << wall_seconds * 1000.0 << ",\n  \"assets\": [";
+    bool first = true;
+    for (const auto& entry : records_)
+    {
+        out << (first ? "\n" : ",\n") << "    { \"name\": " << json_string(entry.first);
+        for (int stage = 0; stage < stage_count; stage++)
+        {
+            out << ", \"" << stage_names[stage] << "_ms\": " << entry.second.seconds[stage] * 1000.0
+                << ", \"" << stage_names[stage] << "_bytes\": " << entry.second.bytes[stage];
+            totals.seconds[stage] += entry.second.seconds[stage];
+            totals.bytes[stage] += entry.second.bytes[stage];
+        }
+        out << ", \"total_ms\": " << total_seconds(entry.second) * 1000.0 << " }";
+        first = false;
+    }
+    out << "\n  ],\n  \"stages\": {";
+    for (int stage = 0; stage < stage_count; stage++)
+        out << (stage > 0 ? ", " : " ") << "\"" << stage_names[stage] << "_ms\": " << totals.seconds[stage] * 1000.0
+            << ", \"" << stage_names[stage] << "_bytes\": " << totals.bytes[stage];
+    out << " },\n  \"image_arena_heap_blocks\": " << image_arena_heap_allocations() << "\n}\n";
+    return static_cast<bool>(out);
+}
+
+void LoadProfiler::reset()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    records_.clear();
+}
+
+
+LoadTimer::LoadTimer(const std::string& asset, load_stage stage, std::size_t bytes)
+    : asset_(asset), stage_(stage), bytes_(bytes), start_(std::chrono::steady_clock::now()) { }
+
+LoadTimer::~LoadTimer()
+{
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - this->start_;
+    LoadProfiler::record(this->asset_, this->stage_, elapsed.count(), this->bytes_);
+}
+
+void LoadTimer::set_bytes(std::size_t bytes)
+{
+    this->bytes_ = bytes;
+}
\ No newline at end of file
@@ -0,0 +1,64 @@
+#ifndef LOAD_PROFILER_H
+#define LOAD_PROFILER_H
+
+#include <chrono>
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <string>
+
+// Stages an asset goes through while loading
+enum load_stage {
+    stage_io,      // reading files (or cache entries) from disk
+    stage_decode,  // image decoding (stbi_load) / container parsing
+    stage_convert, // CPU-side conversion: mip chain generation, cache writes
+    stage_upload,  // GL calls: texture upload, shader compile and link
+    stage_count
+};
+
+// Time and bytes spent on one asset, per stage
+struct AssetLoadRecord
+{
+    double      seconds[stage_count] = {};
+    std::size_t bytes[stage_count] = {};
+};
+
+// A static collector of per-asset load timings. Stages may be recorded from
+// any thread; timings of assets decoded concurrently are per-asset work, not
+// wall-clock time, so the report also carries the total wall time given to it.
+class LoadProfiler
+{
+public:
+    // adds time and bytes to a stage of an asset (thread-safe)
+    static void record(const std::string& asset, load_stage stage, double seconds, std::size_t bytes);
+    // prints a table of all assets, slowest first, and how many blocks the image arena took from the heap
+    static void print_report(std::ostream& out, double wall_seconds);
+    // writes the same data as JSON for tooling (e.g. regression checks in CI); returns false if the file cannot be written
+    static bool write_json(const char* file, double wall_seconds);
+    // forgets everything recorded so far
+    static void reset();
+private:
+    LoadProfiler() = default;
+    static std::mutex                             mutex_;
+    static std::map<std::string, AssetLoadRecord> records_;
+};
+
+// Measures the lifetime of a scope and records it as one stage of an asset
+class LoadTimer
+{
+public:
+    LoadTimer(const std::string& asset, load_stage stage, std::size_t bytes = 0);
+    ~LoadTimer();
+    LoadTimer(const LoadTimer&) = delete;
+    LoadTimer& operator=(const LoadTimer&) = delete;
+    // sets the byte count when it is only known at the end of the scope
+    void set_bytes(std::size_t bytes);
+private:
+    std::string                           asset_;
+    load_stage                            stage_;
+    std::size_t                           bytes_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,235 @@
+#include "mipmap.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MIPMAP_SSE2
+#include <emmintrin.h>
+#endif
+
+
+std::size_t mip_chain_size(unsigned int width, unsigned int height, unsigned int channels)
+{
+    std::size_t size = 0;
+    for (;;)
+    {
+        size += static_cast<std::size_t>(width) * height * channels;
+        if (width == 1 && height == 1)
+            return size;
+        width = width > 1 ? width / 2 : 1;
+        height = height > 1 ? height / 2 : 1;
+    }
+}
+
+unsigned int mip_level_count(unsigned int width, unsigned int height)
+{
+    unsigned int levels = 1;
+    while (width > 1 || height > 1)
+    {
+        width = width > 1 ? width / 2 : 1;
+        height = height > 1 ? height / 2 : 1;
+        levels++;
+    }
+    return levels;
+}
+
+// 2x2 box filter; the last row/column is repeated for odd sizes
+static void downsample_box(const unsigned char* source, unsigned int width, unsigned int height, unsigned int channels, unsigned char* destination)
+{
+    const unsigned int dest_width = width > 1 ? width / 2 : 1;
+    const unsigned int dest_height = height > 1 ? height / 2 : 1;
+    for (unsigned int y = 0; y < dest_height; y++)
+    {
+        const unsigned char* row0 = source + static_cast<std::size_t>(y * 2) * width * channels;
+        const unsigned char* row1 = y * 2 + 1 < height ? row0 + static_cast<std::size_t>(width) * channels : row0;
+        unsigned char* out = destination + static_cast<std::size_t>(y) * dest_width * channels;
+        unsigned int x = 0;
+#ifdef MIPMAP_SSE2
+        // RGBA: two destination pixels (four source pixels per row) at a time, summed exactly in 16 bits
+        if (channels == 4)
+        {
+            const __m128i zero = _mm_setzero_si128();
+            const __m128i rounding = _mm_set1_epi16(2);
+            for (; x * 2 + 3 < width; x += 2)
+            {
+                const __m128i top = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row0 + x * 8));
+                const __m128i bottom = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row1 + x * 8));
+                const __m128i left = _mm_add_epi16(_mm_unpacklo_epi8(top, zero), _mm_unpacklo_epi8(bottom, zero));   // source pixels 0, 1
+                const __m128i right = _mm_add_epi16(_mm_unpackhi_epi8(top, zero), _mm_unpackhi_epi8(bottom, zero)); // source pixels 2, 3
+                __m128i sum = _mm_add_epi16(_mm_unpacklo_epi64(left, right), _mm_unpackhi_epi64(left, right));
+                sum = _mm_srli_epi16(_mm_add_epi16(sum, rounding), 2);
+                _mm_storel_epi64(reinterpret_cast<__m128i*>(out + x * 4), _mm_packus_epi16(sum, zero));
+            }
+        }
+#endif
+        for (; x < dest_width; x++)
+        {
+            const unsigned int x0 = x * 2 * channels;
+            const unsigned int x1 = x * 2 + 1 < width ? x0 + channels : x0;
+            for (unsigned int c = 0; c < channels; c++)
+                out[x * channels + c] = static_cast<unsigned char>((row0[x0 + c] + row0[x1 + c] + row1[x0 + c] + row1[x1 + c] + 2) / 4);
+        }
+    }
+}
+
+// zeroth order modified Bessel function of the first kind (series expansion)
+static double bessel_i0(double x)
+{
+    double sum = 1.0, term = 1.0;
+    for (int k = 1; k < 32; k++)
+    {
+        term *= (x / (2.0 * k)) * (x / (2.0 * k));
+        sum += term;
+        if (term < sum * 1e-12)
+            break;
+    }
+    return sum;
+}
+
+// Kaiser-windowed sinc, evaluated in destination pixel units
+static double kaiser_sinc(double x)
+{
+    constexpr double pi = 3.14159265358979323846;
+    constexpr double width = 3.0; // filter support in destination pixels
+    constexpr double alpha = 4.0; // window shape
+    const double t = x / width;
+    if (t <= -1.0 || t >= 1.0)
+        return 0.0;
+    const double sinc = x == 0.0 ? 1.0 : std::sin(pi * x) / (pi * x);
+    return sinc * bessel_i0(alpha * std::sqrt(1.0 - t * t)) / bessel_i0(alpha);
+}
+
+// separable Kaiser downsample: horizontal pass into a float buffer, then vertical pass
+static void downsample_kaiser(const unsigned char* source, unsigned int width, unsigned int height, unsigned int channels, unsigned char* destination)
+{
+    constexpr int taps = 12; // two source pixels per destination pixel over the filter width on each side
+    float weights[taps];
+    double total = 0.0;
+    for (int i = 0; i < taps; i++)
+    {
+        // source pixel centres relative to the destination pixel centre, in destination pixel units
+        weights[i] = static_cast<float>(kaiser_sinc((i - taps / 2 + 0.5) / 2.0));
+        total += weights[i];
+    }
+    for (float& weight : weights)
+        weight = static_cast<float>(weight / total);
+
+    const unsigned int dest_width = width > 1 ? width / 2 : 1;
+    const unsigned int dest_height = height > 1 ? height / 2 : 1;
+    // a 1 pixel wide axis is copied rather than filtered
+    const bool filter_x = width > 1, filter_y = height > 1;
+
+#ifdef MIPMAP_SSE2
+    // the vector paths add the taps in the same order as the scalar code, so both give the same result
+    const __m128i zero = _mm_setzero_si128();
+    __m128 weight_vectors[taps];
+    for (int i = 0; i < taps; i++)
+        weight_vectors[i] = _mm_set1_ps(weights[i]);
+#endif
+
+    std::vector<float> horizontal(static_cast<std::size_t>(dest_width) * height * channels);
+    for (unsigned int y = 0; y < height; y++)
+    {
+        const unsigned char* row = source + static_cast<std::size_t>(y) * width * channels;
+        float* out = horizontal.data() + static_cast<std::size_t>(y) * dest_width * channels;
+        for (unsigned int x = 0; x < dest_width; x++)
+        {
+#ifdef MIPMAP_SSE2
+            // RGBA away from the edges: one destination pixel per vector, its taps are three 16 byte loads
+            const int first = static_cast<int>(x * 2) - taps / 2 + 1;
+            if (channels == 4 && filter_x && first >= 0 && first + taps <= static_cast<int>(width))
+            {
+                __m128 sum = _mm_setzero_ps();
+                for (int i = 0; i < taps; i += 4)
+                {
+                    const __m128i texels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + (first + i) * 4));
+                    const __m128i low = _mm_unpacklo_epi8(texels, zero), high = _mm_unpackhi_epi8(texels, zero);
+                    sum = _mm_add_ps(sum, _mm_mul_ps(weight_vectors[i + 0], _mm_cvtepi32_ps(_mm_unpacklo_epi16(low, zero))));
+                    sum = _mm_add_ps(sum, _mm_mul_ps(weight_vectors[i + 1], _mm_cvtepi32_ps(_mm_unpackhi_epi16(low, zero))));
+                    sum = _mm_add_ps(sum, _mm_mul_ps(weight_vectors[i + 2], _mm_cvtepi32_ps(_mm_unpacklo_epi16(high, zero))));
+                    sum = _mm_add_ps(sum, _mm_mul_ps(weight_vectors[i + 3], _mm_cvtepi32_ps(_mm_unpackhi_epi16(high, zero))));
+                }
+                _mm_storeu_ps(out + x * 4, sum);
+                continue;
+            }
+#endif
+            for (unsigned int c = 0; c < channels; c++)
+            {
+                float sum = 0.0f;
+                if (!filter_x)
+                    sum = row[c];
+                for (int i = 0; filter_x && i < taps; i++)
+                {
+                    const int sx = std::min(std::max(static_cast<int>(x * 2) + i - taps / 2 + 1, 0), static_cast<int>(width) - 1);
+                    sum += weights[i] * row[sx * channels + c];
+                }
+                out[x * channels + c] = sum;
+            }
+        }
+    }
+    const unsigned int row_size = dest_width * channels;
+    for (unsigned int y = 0; y < dest_height; y++)
+    {
+        unsigned char* out = destination + static_cast<std::size_t>(y) * row_size;
+        // the rows under each tap, clamped at the top and bottom edge
+        const float* rows[taps];
+        for (int t = 0; t < taps; t++)
+        {
+            const int sy = std::min(std::max(static_cast<int>(y * 2) + t - taps / 2 + 1, 0), static_cast<int>(height) - 1);
+            rows[t] = horizontal.data() + static_cast<std::size_t>(sy) * row_size;
+        }
+        unsigned int i = 0;
+#ifdef MIPMAP_SSE2
+        // four outputs at a time, whatever the channel count
+        if (filter_y)
+        {
+            const __m128 half = _mm_set1_ps(0.5f), lowest = _mm_setzero_ps(), highest = _mm_set1_ps(255.0f);
+            for (; i + 4 <= row_size; i += 4)
+            {
+                __m128 sum = _mm_setzero_ps();
+                for (int t = 0; t < taps; t++)
+                    sum = _mm_add_ps(sum, _mm_mul_ps(weight_vectors[t], _mm_loadu_ps(rows[t] + i)));
+                const __m128i value = _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(_mm_add_ps(sum, half), lowest), highest));
+                const int packed = _mm_cvtsi128_si32(_mm_packus_epi16(_mm_packs_epi32(value, zero), zero));
+                std::memcpy(out + i, &packed, 4);
+            }
+        }
+#endif
+        for (; i < row_size; i++)
+        {
+            float sum = 0.0f;
+            if (!filter_y)
+                sum = horizontal[i];
+            for (int t = 0; filter_y && t < taps; t++)
+                sum += weights[t] * rows[t][i];
+            // the negative lobes of the sinc can over- and undershoot
+            out[i] = static_cast<unsigned char>(std::min(std::max(sum + 0.5f, 0.0f), 255.0f));
+        }
+    }
+}
+
+void downsample(const unsigned char* source, unsigned int width, unsigned int height, unsigned int channels, unsigned char* destination, mip_filter filter)
+{
+    if (filter == mip_filter_kaiser)
+        downsample_kaiser(source, width, height, channels, destination);
+    else
+        downsample_box(source, width, height, channels, destination);
+}
+
+std::vector<unsigned char> build_mip_chain(const unsigned char* pixels, unsigned int width, unsigned int height, unsigned int channels, mip_filter filter)
+{
+    std::vector<unsigned char> chain(mip_chain_size(width, height, channels));
+    std::memcpy(chain.data(), pixels, static_cast<std::size_t>(width) * height * channels);
+    std::size_t offset = 0;
+    while (width > 1 || height > 1)
+    {
+        const std::size_t next = offset + static_cast<std::size_t>(width) * height * channels;
+        downsample(chain.data() + offset, width, height, channels, chain.data() + next, filter);
+        offset = next;
+        width = width > 1 ? width / 2 : 1;
+        height = height > 1 ? height / 2 : 1;
+    }
+    return chain;
+}
\ No newline at end of file
@@ -0,0 +1,23 @@
+#ifndef MIPMAP_H
+#define MIPMAP_H
+
+#include <cstddef>
+#include <vector>
+
+
+// Downsampling filter used to build mip chains on the CPU
+enum mip_filter {
+    mip_filter_box,    // 2x2 average, fast (SSE2 for RGBA images)
+    mip_filter_kaiser  // Kaiser-windowed sinc, sharper and less aliasing, several times slower
+};
+
+// size in bytes of a full mip chain for an image, level 0 included
+std::size_t  mip_chain_size(unsigned int width, unsigned int height, unsigned int channels);
+// number of levels in a full mip chain (down to 1x1)
+unsigned int mip_level_count(unsigned int width, unsigned int height);
+// halves an image (tightly packed, 8 bits per channel); destination must hold max(width/2,1) * max(height/2,1) pixels
+void         downsample(const unsigned char* source, unsigned int width, unsigned int height, unsigned int channels, unsigned char* destination, mip_filter filter);
+// builds the full mip chain of an image; levels are tightly packed one after another, starting with a copy of level 0
+std::vector<unsigned char> build_mip_chain(const unsigned char* pixels, unsigned int width, unsigned int height, unsigned int channels, mip_filter filter);
+
+#endif
\ No newline at end of file
@@ -0,0 +1,97 @@
+#include "pixel_buffer_pool.h"
+
+#include <glad/glad.h>
+
+
+PixelBufferPool::PixelBufferPool(unsigned int buffer_count)
+    : buffers_(buffer_count)
+{
+    for (PixelBuffer& buffer : this->buffers_)
+    {
+        glGenBuffers(1, &buffer.id);
+        buffer.capacity = 0;
+        buffer.data = nullptr;
+        buffer.fence = nullptr;
+        buffer.in_use = false;
+    }
+}
+
+PixelBufferPool::~PixelBufferPool()
+{
+    for (PixelBuffer& buffer : this->buffers_)
+    {
+        if (buffer.data != nullptr)
+        {
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer.id);
+            glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+        }
+        if (buffer.fence != nullptr)
+            glDeleteSync(static_cast<GLsync>(buffer.fence));
+        glDeleteBuffers(1, &buffer.id);
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
+
+PixelBuffer* PixelBufferPool::acquire(std::size_t size)
+{
+    for (PixelBuffer& buffer : this->buffers_)
+    {
+        if (buffer.in_use)
+            continue;
+        // skip buffers the GPU may still be reading from (zero timeout: never stall the frame)
+        if (buffer.fence != nullptr)
+        {
+            const GLenum status = glClientWaitSync(static_cast<GLsync>(buffer.fence), 0, 0);
+            if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+                continue;
+            glDeleteSync(static_cast<GLsync>(buffer.fence));
+            buffer.fence = nullptr;
+        }
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer.id);
+        if (buffer.capacity < size)
+        {
+            glBufferData(GL_PIXEL_UNPACK_BUFFER, static_cast<GLsizeiptr>(size), nullptr, GL_STREAM_DRAW);
+            buffer.capacity = size;
+        }
+        // the fence guarantees the previous upload is done, so the driver need not synchronize the mapping
+        buffer.data = static_cast<unsigned char*>(glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, static_cast<GLsizeiptr>(size),
+            GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT | GL_MAP_UNSYNCHRONIZED_BIT));
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        if (buffer.data == nullptr)
+            return nullptr;
+        buffer.in_use = true;
+        return &buffer;
+    }
+    return nullptr;
+}
+
+void PixelBufferPool::upload(PixelBuffer* buffer, Texture2D& texture)
+{
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer->id);
+    glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+    buffer->data = nullptr;
+    // with a PBO bound the data pointer is an offset into the buffer
+    texture.update(texture.width, texture.height, nullptr);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    this->retire(buffer);
+}
+
+void PixelBufferPool::release(PixelBuffer* buffer)
+{
+    if (buffer->data != nullptr)
+    {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer->id);
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        buffer->data = nullptr;
+    }
+    this->retire(buffer);
+}
+
+void PixelBufferPool::retire(PixelBuffer* buffer)
+{
+    if (buffer->fence != nullptr)
+        glDeleteSync(static_cast<GLsync>(buffer->fence));
+    buffer->fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    buffer->in_use = false;
+}
\ No newline at end of file
@@ -0,0 +1,46 @@
+#ifndef PIXEL_BUFFER_POOL_H
+#define PIXEL_BUFFER_POOL_H
+
+#include <cstddef>
+#include <vector>
+
+#include "texture.h"
+
+
+// A pixel unpack buffer object (PBO) handed out by PixelBufferPool.
+// While acquired, data points at the mapped buffer memory and may be
+// written from any thread.
+struct PixelBuffer
+{
+    unsigned int   id;       // GL buffer object
+    std::size_t    capacity; // allocated size of the buffer object in bytes
+    unsigned char* data;     // mapped memory, nullptr while not acquired
+    void*          fence;    // GLsync guarding the last upload that read from the buffer
+    bool           in_use;
+};
+
+// Pool of pixel unpack buffers used to stream texture data to the GPU.
+// Uploads from a PBO are asynchronous: glTexSubImage2D returns right away and
+// the driver copies from the buffer later, so a fence marks when a buffer can be
+// reused. acquire(), upload() and release() must be called on the GL thread.
+class PixelBufferPool
+{
+public:
+    // constructor/destructor
+    explicit PixelBufferPool(unsigned int buffer_count);
+    ~PixelBufferPool();
+    PixelBufferPool(const PixelBufferPool&) = delete;
+    PixelBufferPool& operator=(const PixelBufferPool&) = delete;
+    // maps a free buffer of at least size bytes, or returns nullptr if every buffer is still in flight
+    PixelBuffer* acquire(std::size_t size);
+    // unmaps the buffer and uploads its content into the (already allocated) texture, then returns the buffer to the pool
+    void         upload(PixelBuffer* buffer, Texture2D& texture);
+    // unmaps the buffer and returns it to the pool without uploading anything
+    void         release(PixelBuffer* buffer);
+private:
+    std::vector<PixelBuffer> buffers_;
+    // unmaps the buffer and fences it against the commands issued so far
+    void         retire(PixelBuffer* buffer);
+};
+
+#endif
\ No newline at end of file
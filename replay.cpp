@@ -0,0 +1,266 @@
+#include "replay.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <iterator>
+
+// records are collected up to this size before the writer thread gets them
+constexpr std::size_t replay_buffer_size = 64 * 1024;
+// longest input run accepted when loading
+constexpr std::uint64_t max_replay_run = 1ULL << 28;
+
+template <typename T>
+static void append(std::vector<char>& buffer, const T& value)
+{
+    const char* bytes = reinterpret_cast<const char*>(&value);
+    buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+}
+
+static void append_varint(std::vector<char>& buffer, std::uint64_t value)
+{
+    do
+    {
+        const unsigned char low = value & 0x7f;
+        value >>= 7;
+        buffer.push_back(static_cast<char>(value != 0 ? low | 0x80 : low));
+    } while (value != 0);
+}
+
+ReplayWriter::ReplayWriter()
+    : keyframe_interval_(0), start_tick_(0), run_bits_(0), run_length_(0), closing_(false)
+{
+
+}
+
+ReplayWriter::~ReplayWriter()
+{
+    this->close();
+}
+
+bool ReplayWriter::open(const char* file, const Simulation& simulation, const float step_length, const unsigned int keyframe_interval)
+{
+    this->close();
+    this->file_.open(file, std::ios::binary | std::ios::trunc);
+    if (!this->file_)
+    {
+        std::cout << "ERROR::REPLAY: Failed to open " << file << " for writing" << std::endl;
+        return false;
+    }
+    this->keyframe_interval_ = std::max(keyframe_interval, 1u);
+    this->start_tick_ = simulation.tick;
+    this->run_length_ = 0;
+    this->closing_ = false;
+
+    ReplayHeader header;
+    std::memcpy(header.magic, replay_magic, sizeof(header.magic));
+    header.version = replay_version;
+    header.width = simulation.width;
+    header.height = simulation.height;
+    header.step_length = step_length;
+    header.keyframe_interval = this->keyframe_interval_;
+    this->buffer_.reserve(replay_buffer_size + 256);
+    append(this->buffer_, header);
+    this->buffer_.push_back(replay_keyframe);
+    append(this->buffer_, simulation.save());
+
+    this->writer_ = std::thread(&ReplayWriter::writer_loop, this);
+    return true;
+}
+
+void ReplayWriter::record(const Simulation& simulation, const SimulationInput& input)
+{
+    if (!this->is_open())
+        return;
+    // keyframes sit between input runs, right before the input of their tick
+    if (simulation.tick != this->start_tick_ && (simulation.tick - this->start_tick_) % this->keyframe_interval_ == 0)
+    {
+        this->end_run();
+        this->buffer_.push_back(replay_keyframe);
+        append(this->buffer_, simulation.save());
+    }
+    const unsigned char bits = pack_input(input);
+    if (this->run_length_ > 0 && bits != this->run_bits_)
+        this->end_run();
+    this->run_bits_ = bits;
+    this->run_length_++;
+
+    if (this->buffer_.size() >= replay_buffer_size)
+        this->hand_over();
+}
+
+void ReplayWriter::close()
+{
+    if (!this->is_open())
+        return;
+    this->end_run();
+    this->hand_over();
+    {
+        std::lock_guard<std::mutex> lock(this->mutex_);
+        this->closing_ = true;
+    }
+    this->pending_signal_.notify_one();
+    this->writer_.join();
+    this->file_.close();
+}
+
+bool ReplayWriter::is_open() const
+{
+    return this->writer_.joinable();
+}
+
+void ReplayWriter::end_run()
+{
+    if (this->run_length_ == 0)
+        return;
+    this->buffer_.push_back(replay_inputs);
+    this->buffer_.push_back(static_cast<char>(this->run_bits_));
+    append_varint(this->buffer_, this->run_length_);
+    this->run_length_ = 0;
+}
+
+void ReplayWriter::hand_over()
+{
+    if (this->buffer_.empty())
+        return;
+    {
+        std::lock_guard<std::mutex> lock(this->mutex_);
+        this->pending_.push_back(std::move(this->buffer_));
+    }
+    this->pending_signal_.notify_one();
+    this->buffer_ = std::vector<char>();
+    this->buffer_.reserve(replay_buffer_size + 256);
+}
+
+void ReplayWriter::writer_loop()
+{
+    std::unique_lock<std::mutex> lock(this->mutex_);
+    while (true)
+    {
+        this->pending_signal_.wait(lock, [this] { return this->closing_ || !this->pending_.empty(); });
+        while (!this->pending_.empty())
+        {
+            const std::vector<char> chunk = std::move(this->pending_.front());
+            this->pending_.pop_front();
+            lock.unlock();
+            this->file_.write(chunk.data(), chunk.size());
+            lock.lock();
+        }
+        if (this->closing_)
+            break;
+    }
+    this->file_.flush();
+}
+
+Replay::Replay()
+    : width(0), height(0), step_length(0.0f)
+{
+
+}
+
+bool Replay::load(const char* file)
+{
+    this->keyframes_.clear();
+    this->inputs_.clear();
+    std::ifstream in(file, std::ios::binary);
+    const std::vector<char> data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    ReplayHeader header;
+    if (data.size() < sizeof(header) || std::memcmp(data.data(), replay_magic, sizeof(replay_magic)) != 0)
+    {
+        std::cout << "ERROR::REPLAY: " << file << " is not a replay" << std::endl;
+        return false;
+    }
+    std::memcpy(&header, data.data(), sizeof(header));
+    if (header.version != replay_version)
+    {
+        std::cout << "ERROR::REPLAY: " << file << " has version " << header.version << ", expected " << replay_version << std::endl;
+        return false;
+    }
+    this->width = header.width;
+    this->height = header.height;
+    this->step_length = header.step_length;
+
+    // a recording cut short (the game crashed) is still played up to its last complete record
+    std::size_t offset = sizeof(header);
+    while (offset < data.size())
+    {
+        const unsigned char tag = static_cast<unsigned char>(data[offset]);
+        if (tag == replay_keyframe && offset + 1 + sizeof(SimulationState) <= data.size())
+        {
+            SimulationState keyframe;
+            std::memcpy(&keyframe, &data[offset + 1], sizeof(keyframe));
+            if (!this->keyframes_.empty() && keyframe.tick != this->keyframes_.front().tick + this->inputs_.size())
+                break;
+            this->keyframes_.push_back(keyframe);
+            offset += 1 + sizeof(keyframe);
+        }
+        else if (tag == replay_inputs && offset + 2 < data.size() && !this->keyframes_.empty())
+        {
+            const unsigned char bits = static_cast<unsigned char>(data[offset + 1]);
+            std::uint64_t run = 0;
+            std::size_t end = offset + 2;
+            for (unsigned int shift = 0; end < data.size() && shift < 64; shift += 7)
+            {
+                const unsigned char byte = static_cast<unsigned char>(data[end++]);
+                run |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+                // a run longer than a day of play is a corrupt file
+                if ((byte & 0x80) == 0 && run <= max_replay_run)
+                {
+                    this->inputs_.insert(this->inputs_.end(), static_cast<std::size_t>(run), bits);
+                    offset = end;
+                    break;
+                }
+            }
+            if (offset != end)
+                break;
+        }
+        else
+            break;
+    }
+    if (this->keyframes_.empty())
+    {
+        std::cout << "ERROR::REPLAY: " << file << " holds no keyframe" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+std::uint64_t Replay::first_tick() const
+{
+    return this->keyframes_.empty() ? 0 : this->keyframes_.front().tick;
+}
+
+std::uint64_t Replay::end_tick() const
+{
+    return this->first_tick() + this->inputs_.size();
+}
+
+SimulationInput Replay::input(const std::uint64_t tick) const
+{
+    if (tick < this->first_tick() || tick >= this->end_tick())
+        return SimulationInput();
+    return unpack_input(this->inputs_[static_cast<std::size_t>(tick - this->first_tick())]);
+}
+
+bool Replay::seek(Simulation& simulation, const std::uint64_t tick) const
+{
+    if (this->keyframes_.empty() || tick < this->first_tick() || tick > this->end_tick())
+        return false;
+    // last keyframe at or before tick
+    const auto keyframe = std::upper_bound(this->keyframes_.begin(), this->keyframes_.end(), tick,
+        [](const std::uint64_t target, const SimulationState& k) { return target < k.tick; }) - 1;
+    simulation.restore(*keyframe);
+    while (simulation.tick < tick)
+        simulation.step(this->input(simulation.tick), this->step_length);
+    return true;
+}
+
+bool Replay::verify(const Simulation& simulation) const
+{
+    const auto keyframe = std::lower_bound(this->keyframes_.begin(), this->keyframes_.end(), simulation.tick,
+        [](const SimulationState& k, const std::uint64_t target) { return k.tick < target; });
+    if (keyframe == this->keyframes_.end() || keyframe->tick != simulation.tick)
+        return true;
+    const SimulationState state = simulation.save();
+    return std::memcmp(&state, &*keyframe, sizeof(state)) == 0;
+}
\ No newline at end of file
@@ -0,0 +1,103 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "simulation.h"
+
+// Replay file layout (little endian):
+//   ReplayHeader | records...
+// Each record is a replay_record tag byte followed by its payload:
+//   replay_keyframe: a SimulationState, the full state before the input of its tick
+//   replay_inputs:   input_bit flags (1 byte), then the number of consecutive ticks they were held as a varint
+// Inputs rarely change from one tick to the next, so a match costs a few bytes per second plus the keyframes.
+constexpr char          replay_magic[4] = { 'P', 'P', 'R', 'P' };
+constexpr std::uint32_t replay_version = 2;
+
+enum replay_record : unsigned char {
+    replay_keyframe = 'K',
+    replay_inputs = 'I'
+};
+
+struct ReplayHeader
+{
+    char          magic[4];
+    std::uint32_t version;
+    std::uint32_t width;             // arena size
+    std::uint32_t height;
+    float         step_length;       // dt of every step, playback must use the same one
+    std::uint32_t keyframe_interval; // ticks between keyframes
+};
+
+static_assert(sizeof(ReplayHeader) == 24, "ReplayHeader must match the on-disk layout");
+
+
+// Records the inputs of a running simulation. Recording only appends to a memory buffer;
+// full buffers are written to disk by a writer thread, so it costs no frame time.
+class ReplayWriter
+{
+public:
+    ReplayWriter();
+    ~ReplayWriter();
+    ReplayWriter(const ReplayWriter&) = delete;
+    ReplayWriter& operator=(const ReplayWriter&) = delete;
+
+    // starts a recording with a keyframe of the current state; returns false if the file cannot be created
+    bool open(const char* file, const Simulation& simulation, float step_length, unsigned int keyframe_interval = 240);
+    // records the input about to be stepped (call right before Simulation::step)
+    void record(const Simulation& simulation, const SimulationInput& input);
+    // writes out everything recorded and stops the writer thread
+    void close();
+    bool is_open() const;
+private:
+    std::ofstream                 file_;
+    unsigned int                  keyframe_interval_;
+    std::uint64_t                 start_tick_;
+    // run of identical inputs not written to the buffer yet
+    unsigned char                 run_bits_;
+    std::uint64_t                 run_length_;
+    // filled by record, handed to the writer thread when full
+    std::vector<char>             buffer_;
+    std::thread                   writer_;
+    std::mutex                    mutex_;
+    std::condition_variable       pending_signal_;
+    std::deque<std::vector<char>> pending_;
+    bool                          closing_;
+
+    void end_run();
+    void hand_over();
+    void writer_loop();
+};
+
+// A recording loaded for playback. Seeking restores the nearest keyframe at or before
+// the target tick and re-simulates from there with the recorded inputs.
+class Replay
+{
+public:
+    unsigned int width, height;
+    float        step_length;
+
+    Replay();
+    // reads and indexes a replay file; returns false if it cannot be read or is not a replay
+    bool          load(const char* file);
+    // ticks covered by the recording: inputs exist for [first_tick(), end_tick())
+    std::uint64_t first_tick() const;
+    std::uint64_t end_tick() const;
+    // input recorded for a tick (no input outside the recording)
+    SimulationInput input(std::uint64_t tick) const;
+    // puts the simulation in its recorded state at tick; returns false if the tick is not covered
+    bool          seek(Simulation& simulation, std::uint64_t tick) const;
+    // compares the simulation with the keyframe at its tick, if there is one; false means playback diverged
+    bool          verify(const Simulation& simulation) const;
+private:
+    std::vector<SimulationState> keyframes_; // sorted by tick
+    std::vector<unsigned char>   inputs_;    // input_bit flags of every tick from the first keyframe on
+};
+
+#endif
\ No newline at end of file
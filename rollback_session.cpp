@@ -0,0 +1,234 @@
+#include "rollback_session.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+
+RollbackSession::RollbackSession()
+    : stats(), local_player_(1), input_delay_(0), step_length_(0.0f), local_mask_(0), remote_mask_(0), local_inputs_(), remote_inputs_(),
+      snapshots_(), local_last_(-1), remote_confirmed_(-1), peer_ack_(-1), peer_tick_(0), rollback_from_(-1), echo_time_(0),
+      rate_mismatch_reported_(false), same_player_reported_(false)
+{
+
+}
+
+bool RollbackSession::start(const unsigned short local_port, const char* peer_host, const unsigned short peer_port, const unsigned int local_player,
+                            const unsigned int input_delay, const float step_length)
+{
+    if (!this->socket_.open(local_port, peer_host, peer_port))
+        return false;
+    this->stats = NetStats();
+    this->local_player_ = local_player == 2 ? 2 : 1;
+    this->input_delay_ = std::min(input_delay, max_input_delay);
+    this->step_length_ = step_length;
+    // launch comes from either side, each paddle only from its own player
+    const unsigned char player1_bits = input_player1_up | input_player1_down | input_launch;
+    const unsigned char player2_bits = input_player2_up | input_player2_down | input_launch;
+    this->local_mask_ = this->local_player_ == 1 ? player1_bits : player2_bits;
+    this->remote_mask_ = this->local_player_ == 1 ? player2_bits : player1_bits;
+    std::memset(this->local_inputs_, 0, sizeof(this->local_inputs_));
+    std::memset(this->remote_inputs_, 0, sizeof(this->remote_inputs_));
+    // the first input_delay ticks have no local input
+    this->local_last_ = static_cast<std::int64_t>(this->input_delay_) - 1;
+    this->remote_confirmed_ = -1;
+    this->peer_ack_ = -1;
+    this->peer_tick_ = 0;
+    this->rollback_from_ = -1;
+    this->peer_hashes_.clear();
+    this->echo_time_ = 0;
+    this->rate_mismatch_reported_ = false;
+    this->same_player_reported_ = false;
+    this->start_time_ = std::chrono::steady_clock::now();
+    return true;
+}
+
+bool RollbackSession::is_active() const
+{
+    return this->socket_.is_open();
+}
+
+unsigned int RollbackSession::local_player() const
+{
+    return this->local_player_;
+}
+
+unsigned int RollbackSession::input_delay() const
+{
+    return this->input_delay_;
+}
+
+bool RollbackSession::advance(Simulation& simulation, const SimulationInput& input)
+{
+    this->receive(simulation);
+
+    // correct wrong predictions: restore the earliest wrong tick and re-simulate up to the present
+    if (this->rollback_from_ >= 0)
+    {
+        const std::int64_t present = static_cast<std::int64_t>(simulation.tick);
+        simulation.restore(this->snapshots_[this->rollback_from_ % rollback_history]);
+        while (static_cast<std::int64_t>(simulation.tick) < present)
+            this->simulate_tick(simulation);
+        this->stats.rollback_ticks = static_cast<unsigned int>(present - this->rollback_from_);
+        this->stats.rollbacks++;
+        this->rollback_from_ = -1;
+    }
+    this->check_hash(simulation);
+
+    // wait instead of predicting past the window, overwriting inputs the peer has not acknowledged,
+    // or running ahead of the peer (its tick estimated from the last packet and half the round trip)
+    const std::int64_t tick = static_cast<std::int64_t>(simulation.tick);
+    const std::int64_t oldest_needed = std::min(this->peer_ack_ + 1, tick - static_cast<std::int64_t>(max_prediction_ticks) - 1);
+    const float peer_tick = static_cast<float>(this->peer_tick_) + this->stats.ping / 2000.0f / this->step_length_;
+    if (!this->stats.connected || tick > this->remote_confirmed_ + static_cast<std::int64_t>(max_prediction_ticks) ||
+        this->local_last_ + 1 - oldest_needed >= static_cast<std::int64_t>(rollback_history) || static_cast<float>(tick) - peer_tick >= 2.0f)
+    {
+        this->stats.stalls++;
+        this->send(simulation);
+        return false;
+    }
+
+    this->local_last_++;
+    this->local_inputs_[this->local_last_ % rollback_history] = pack_input(input) & this->local_mask_;
+    this->simulate_tick(simulation);
+    this->stats.prediction_ticks = static_cast<unsigned int>(std::max<std::int64_t>(0, static_cast<std::int64_t>(simulation.tick) - this->remote_confirmed_ - 1));
+    this->send(simulation);
+    return true;
+}
+
+std::uint32_t RollbackSession::clock_ms() const
+{
+    return static_cast<std::uint32_t>(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - this->start_time_).count());
+}
+
+void RollbackSession::receive(const Simulation& simulation)
+{
+    unsigned char packet[sizeof(NetPacketHeader) + rollback_history];
+    std::size_t size;
+    while ((size = this->socket_.receive(packet, sizeof(packet))) > 0)
+    {
+        NetPacketHeader header;
+        if (size < sizeof(header))
+            continue;
+        std::memcpy(&header, packet, sizeof(header));
+        if (std::memcmp(header.magic, net_magic, sizeof(net_magic)) != 0 || sizeof(header) + header.input_count > size)
+            continue;
+        if (header.step_length != this->step_length_)
+        {
+            if (!this->rate_mismatch_reported_)
+                std::cout << "ERROR::NETPLAY: The peer runs at " << 1.0f / header.step_length << " ticks per second, expected " << 1.0f / this->step_length_ << std::endl;
+            this->rate_mismatch_reported_ = true;
+            continue;
+        }
+        // both sides driving the same paddle would leave the other one to predictions and desync every tick
+        if (header.player == this->local_player_)
+        {
+            if (!this->same_player_reported_)
+                std::cout << "ERROR::NETPLAY: The peer plays player " << header.player << " as well, start one side with --net-player="
+                          << (this->local_player_ == 1 ? 2 : 1) << std::endl;
+            this->same_player_reported_ = true;
+            this->stats.same_player = true;
+            continue;
+        }
+        this->stats.connected = true;
+        this->stats.packets_received++;
+        this->peer_ack_ = std::max(this->peer_ack_, header.ack_tick);
+        this->peer_tick_ = std::max(this->peer_tick_, header.tick);
+        if (header.echo_time != 0)
+        {
+            const float sample = static_cast<float>(this->clock_ms() + 1 - header.echo_time);
+            this->stats.ping = this->stats.ping == 0.0f ? sample : this->stats.ping * 0.9f + sample * 0.1f;
+        }
+        this->echo_time_ = header.time;
+        // hashes are queued, the peer may be ahead of us by more than one packet
+        if (header.hash_tick >= 0 && (this->peer_hashes_.empty() || header.hash_tick > this->peer_hashes_.back().tick))
+        {
+            if (this->peer_hashes_.size() == rollback_history)
+                this->peer_hashes_.pop_front();
+            this->peer_hashes_.push_back({ header.hash_tick, header.hash });
+        }
+
+        // take the inputs that continue the confirmed ones; a tick already simulated with another prediction must be rolled back
+        for (std::uint32_t i = 0; i < header.input_count; i++)
+        {
+            const std::int64_t tick = header.first_tick + i;
+            if (tick <= this->remote_confirmed_)
+                continue;
+            // a gap, or so far ahead it would overwrite the rollback window: wait for the resend
+            if (tick != this->remote_confirmed_ + 1 ||
+                tick >= static_cast<std::int64_t>(simulation.tick) + rollback_history - max_prediction_ticks - 1)
+                break;
+            const unsigned char bits = packet[sizeof(header) + i] & this->remote_mask_;
+            unsigned char& stored = this->remote_inputs_[tick % rollback_history];
+            if (tick < static_cast<std::int64_t>(simulation.tick) && stored != bits && (this->rollback_from_ < 0 || tick < this->rollback_from_))
+                this->rollback_from_ = tick;
+            stored = bits;
+            this->remote_confirmed_ = tick;
+        }
+    }
+}
+
+void RollbackSession::send(const Simulation& simulation)
+{
+    const std::int64_t tick = static_cast<std::int64_t>(simulation.tick);
+    // every local input the peer has not acknowledged
+    const std::int64_t first = std::max(this->peer_ack_ + 1, this->local_last_ + 1 - static_cast<std::int64_t>(rollback_history));
+    const std::int64_t count = std::max<std::int64_t>(0, this->local_last_ + 1 - first);
+
+    NetPacketHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, net_magic, sizeof(net_magic));
+    header.step_length = this->step_length_;
+    header.first_tick = first;
+    header.ack_tick = this->remote_confirmed_;
+    header.tick = tick;
+    // the latest state both peers have all inputs for
+    header.hash_tick = std::min(this->remote_confirmed_ + 1, tick);
+    header.hash = header.hash_tick == tick ? simulation.state_hash : this->snapshots_[header.hash_tick % rollback_history].state_hash;
+    header.time = this->clock_ms() + 1;
+    header.echo_time = this->echo_time_;
+    header.input_count = static_cast<std::uint32_t>(count);
+    header.player = this->local_player_;
+
+    unsigned char packet[sizeof(NetPacketHeader) + rollback_history];
+    std::memcpy(packet, &header, sizeof(header));
+    for (std::int64_t i = 0; i < count; i++)
+        packet[sizeof(header) + i] = this->local_inputs_[(first + i) % rollback_history];
+    if (this->socket_.send(packet, sizeof(header) + static_cast<std::size_t>(count)))
+        this->stats.packets_sent++;
+}
+
+void RollbackSession::simulate_tick(Simulation& simulation)
+{
+    const std::int64_t tick = static_cast<std::int64_t>(simulation.tick);
+    const std::size_t slot = static_cast<std::size_t>(tick % rollback_history);
+    // prediction: the peer keeps holding what it held last
+    if (tick > this->remote_confirmed_)
+        this->remote_inputs_[slot] = this->remote_confirmed_ >= 0 ? this->remote_inputs_[this->remote_confirmed_ % rollback_history] : 0;
+    this->snapshots_[slot] = simulation.save();
+    simulation.step(unpack_input(this->local_inputs_[slot] | this->remote_inputs_[slot]), this->step_length_);
+}
+
+void RollbackSession::check_hash(const Simulation& simulation)
+{
+    const std::int64_t tick = static_cast<std::int64_t>(simulation.tick);
+    while (!this->peer_hashes_.empty())
+    {
+        const PeerHash& peer = this->peer_hashes_.front();
+        // ours is final once every input before it is confirmed; hashes ahead of that wait for us to catch up
+        if (peer.tick > tick || peer.tick > this->remote_confirmed_ + 1)
+            return;
+        // older than the history it can no longer be checked
+        if (peer.tick > tick - static_cast<std::int64_t>(rollback_history))
+        {
+            const std::uint64_t hash = peer.tick == tick ? simulation.state_hash : this->snapshots_[peer.tick % rollback_history].state_hash;
+            if (hash != peer.hash)
+            {
+                if (this->stats.desyncs == 0)
+                    std::cout << "ERROR::NETPLAY: State diverged from the peer at tick " << peer.tick << std::endl;
+                this->stats.desyncs++;
+            }
+        }
+        this->peer_hashes_.pop_front();
+    }
+}
\ No newline at end of file
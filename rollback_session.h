@@ -0,0 +1,113 @@
+#ifndef ROLLBACK_SESSION_H
+#define ROLLBACK_SESSION_H
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+
+#include "simulation.h"
+#include "udp_socket.h"
+
+// ticks the simulation may run past the last input received from the peer; also the deepest rollback
+constexpr unsigned int max_prediction_ticks = 32;
+// longest accepted input delay, in ticks
+constexpr unsigned int max_input_delay = 16;
+// default input delay: 2 ticks at 240 Hz is half a 60 Hz frame, enough to absorb a LAN round trip without rollbacks
+constexpr unsigned int default_input_delay = 2;
+// ticks of inputs and snapshots kept; covers the rollback window behind the present and both delays ahead of it
+constexpr unsigned int rollback_history = 128;
+
+// Net play packet, sent every tick: a header followed by input_count input bytes starting at first_tick.
+// Every packet repeats all inputs the peer has not acknowledged yet, so lost packets need no resend.
+constexpr char net_magic[4] = { 'P', 'P', 'N', 'T' };
+struct NetPacketHeader
+{
+    char          magic[4];
+    float         step_length;  // both peers must step with the same dt
+    std::int64_t  first_tick;   // tick of the first input in the packet
+    std::int64_t  ack_tick;     // last tick up to which the sender has every input of the receiver, -1 for none
+    std::int64_t  tick;         // tick the sender simulates next, for time sync
+    std::int64_t  hash_tick;    // a tick both peers have all inputs before, and the sender's state_hash at it (-1 for none)
+    std::uint64_t hash;
+    std::uint32_t time;         // sender clock in ms + 1, echoed back to measure the round trip (0 for none)
+    std::uint32_t echo_time;
+    std::uint32_t input_count;
+    std::uint32_t player;       // paddle the sender plays, the peers must play different ones
+};
+static_assert(sizeof(NetPacketHeader) == 64, "NetPacketHeader must match the wire layout");
+
+// network figures for the overlay
+struct NetStats
+{
+    bool          connected;
+    bool          same_player;         // the peer plays our paddle as well, no connection is made
+    float         ping;                // round trip in ms, smoothed
+    unsigned int  prediction_ticks;    // ticks simulated past the last input from the peer
+    unsigned int  rollback_ticks;      // ticks re-simulated by the last rollback
+    std::uint64_t rollbacks;
+    std::uint64_t stalls;              // ticks skipped waiting for the peer or to let it catch up
+    std::uint64_t desyncs;             // state hashes that differed from the peer's
+    std::uint64_t packets_sent, packets_received;
+};
+
+// GGPO-style rollback play between two game instances over UDP. The local input is applied
+// input_delay ticks late and sent every tick; the peer's input is predicted by repeating its last
+// known one, and the state is saved before every step. When the peer's real input for a past tick
+// differs from the prediction, the state of that tick is restored and re-simulated up to the present,
+// so the local paddle never waits on the network. The simulation never runs more than
+// max_prediction_ticks past the peer, which caps the re-simulation of a tick to that many steps.
+class RollbackSession
+{
+public:
+    NetStats stats;
+
+    RollbackSession();
+    // starts a session on local_port with the peer at peer_host:peer_port; local_player (1 or 2) is the
+    // paddle driven here. Both instances start from a new Simulation of the same size and step with the
+    // same step length. Returns false if the socket fails.
+    bool start(unsigned short local_port, const char* peer_host, unsigned short peer_port, unsigned int local_player,
+               unsigned int input_delay, float step_length);
+    bool is_active() const;
+    unsigned int local_player() const;
+    unsigned int input_delay() const;
+    // advances the simulation by one tick with the local input (only the local paddle and launch are read);
+    // rolls back first if the peer's input proved a prediction wrong. Returns false if the tick was skipped
+    // to wait for the peer.
+    bool advance(Simulation& simulation, const SimulationInput& input);
+private:
+    UdpSocket       socket_;
+    unsigned int    local_player_, input_delay_;
+    float           step_length_;
+    unsigned char   local_mask_, remote_mask_; // input_bit flags each side may set
+    // ring buffers indexed by tick % rollback_history
+    unsigned char   local_inputs_[rollback_history];
+    unsigned char   remote_inputs_[rollback_history]; // received up to remote_confirmed_, predicted after it
+    SimulationState snapshots_[rollback_history];     // state before the step of the tick
+    std::int64_t    local_last_;       // last tick with a local input
+    std::int64_t    remote_confirmed_; // last tick up to which every input of the peer arrived
+    std::int64_t    peer_ack_;         // last tick up to which the peer has our inputs
+    std::int64_t    peer_tick_;
+    std::int64_t    rollback_from_;    // earliest tick simulated with a wrong prediction, -1 if none
+    // the peer's state hashes by tick, each checked once our state at that tick is final
+    struct PeerHash
+    {
+        std::int64_t  tick;
+        std::uint64_t hash;
+    };
+    std::deque<PeerHash> peer_hashes_;
+    std::uint32_t   echo_time_;
+    bool            rate_mismatch_reported_;
+    bool            same_player_reported_;
+    std::chrono::steady_clock::time_point start_time_;
+
+    std::uint32_t clock_ms() const;
+    // reads every waiting packet
+    void receive(const Simulation& simulation);
+    void send(const Simulation& simulation);
+    // steps one tick with the stored inputs, predicting the peer's if needed, after saving the snapshot
+    void simulate_tick(Simulation& simulation);
+    // compares the peer's state hashes with ours once both are final
+    void check_hash(const Simulation& simulation);
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,388 @@
+#include "simulation.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <tuple>
+
+// FNV-1a over 32-bit words: a few multiplies per step, enough to tell diverged states apart
+constexpr std::uint64_t hash_basis = 14695981039346656037ULL;
+static std::uint64_t hash_words(std::uint64_t hash, const std::uint32_t* words, const std::size_t count)
+{
+    for (std::size_t i = 0; i < count; i++)
+        hash = (hash ^ words[i]) * 1099511628211ULL;
+    return hash;
+}
+
+// Defines a Collision typedef that represents collision data
+typedef std::tuple<bool, direction, glm::vec2> Collision; // <collision?, what direction?, difference vector center - closest point>
+
+unsigned char pack_input(const SimulationInput& input)
+{
+    return static_cast<unsigned char>((input.player1_up ? input_player1_up : 0) | (input.player1_down ? input_player1_down : 0) |
+                                      (input.player2_up ? input_player2_up : 0) | (input.player2_down ? input_player2_down : 0) |
+                                      (input.launch ? input_launch : 0));
+}
+
+SimulationInput unpack_input(const unsigned char bits)
+{
+    SimulationInput input;
+    input.player1_up = (bits & input_player1_up) != 0;
+    input.player1_down = (bits & input_player1_down) != 0;
+    input.player2_up = (bits & input_player2_up) != 0;
+    input.player2_down = (bits & input_player2_down) != 0;
+    input.launch = (bits & input_launch) != 0;
+    return input;
+}
+
+Simulation::Simulation(const unsigned int width, const unsigned int height)
+    : width(width), height(height), player1(), player2(), ball(glm::vec2(0.0f), ball_radius, initial_ball_velocity), player1_score(0), player2_score(0),
+      tick(0), state_hash(hash_basis)
+{
+    this->reset();
+}
+
+void Simulation::reset()
+{
+    this->reset_player();
+    this->ball.reset(this->player1.position + glm::vec2(player_size.x, player_size.y / 2 - ball_radius), initial_ball_velocity);
+    this->player1_score = 0;
+    this->player2_score = 0;
+}
+
+void Simulation::step(const SimulationInput& input, const float dt)
+{
+    this->player1.previous_position = this->player1.position;
+    this->player2.previous_position = this->player2.position;
+    this->ball.previous_position = this->ball.position;
+
+    this->process_input(input, dt);
+    this->update(dt);
+
+    this->tick++;
+    const std::uint64_t digest = this->hash_state();
+    const std::uint32_t words[2] = { static_cast<std::uint32_t>(digest), static_cast<std::uint32_t>(digest >> 32) };
+    this->state_hash = hash_words(this->state_hash, words, 2);
+}
+
+std::uint64_t Simulation::hash_state() const
+{
+    // the float bit patterns: any difference in the last bit shows
+    const float values[7] = { this->ball.position.x, this->ball.position.y, this->ball.velocity.x, this->ball.velocity.y,
+                              this->player1.position.y, this->player2.position.y, this->ball.stuck ? 1.0f : 0.0f };
+    std::uint32_t words[11];
+    std::memcpy(words, values, sizeof(values));
+    words[7] = this->player1_score;
+    words[8] = this->player2_score;
+    words[9] = static_cast<std::uint32_t>(this->tick);
+    words[10] = static_cast<std::uint32_t>(this->tick >> 32);
+    return hash_words(hash_basis, words, 11);
+}
+
+SimulationState Simulation::save() const
+{
+    SimulationState state;
+    state.tick = this->tick;
+    state.state_hash = this->state_hash;
+    state.width = this->width;
+    state.height = this->height;
+    state.player1_score = this->player1_score;
+    state.player2_score = this->player2_score;
+    state.player1_x = this->player1.position.x;
+    state.player1_y = this->player1.position.y;
+    state.player1_previous_x = this->player1.previous_position.x;
+    state.player1_previous_y = this->player1.previous_position.y;
+    state.player2_x = this->player2.position.x;
+    state.player2_y = this->player2.position.y;
+    state.player2_previous_x = this->player2.previous_position.x;
+    state.player2_previous_y = this->player2.previous_position.y;
+    state.ball_x = this->ball.position.x;
+    state.ball_y = this->ball.position.y;
+    state.ball_previous_x = this->ball.previous_position.x;
+    state.ball_previous_y = this->ball.previous_position.y;
+    state.ball_velocity_x = this->ball.velocity.x;
+    state.ball_velocity_y = this->ball.velocity.y;
+    state.stuck = this->ball.stuck ? 1 : 0;
+    state.reserved = 0;
+    return state;
+}
+
+void Simulation::restore(const SimulationState& state)
+{
+    this->tick = state.tick;
+    this->state_hash = state.state_hash;
+    this->width = state.width;
+    this->height = state.height;
+    this->player1_score = state.player1_score;
+    this->player2_score = state.player2_score;
+    this->player1.position = glm::vec2(state.player1_x, state.player1_y);
+    this->player1.previous_position = glm::vec2(state.player1_previous_x, state.player1_previous_y);
+    this->player2.position = glm::vec2(state.player2_x, state.player2_y);
+    this->player2.previous_position = glm::vec2(state.player2_previous_x, state.player2_previous_y);
+    this->ball.position = glm::vec2(state.ball_x, state.ball_y);
+    this->ball.previous_position = glm::vec2(state.ball_previous_x, state.ball_previous_y);
+    this->ball.velocity = glm::vec2(state.ball_velocity_x, state.ball_velocity_y);
+    this->ball.stuck = state.stuck != 0;
+}
+
+void Simulation::update(float dt)
+{
+    // update objects
+    this->move_ball(&this->ball, dt);
+
+    // check for overlaps the sweep cannot see (a paddle moving into the ball)
+    this->do_collisions(&this->ball, &this->player1);
+    this->do_collisions(&this->ball, &this->player2);
+
+    // check loss condition
+    if (this->ball.position.x <= 0.0f) // Did the ball pass player1?
+    {
+        this->player2_score++;
+        this->reset_player();
+        this->ball.reset(this->player2.position + glm::vec2(-ball_radius * 2, player_size.y / 2 - ball_radius), initial_ball_velocity);
+    }
+    if (this->ball.position.x + this->ball.radius >= this->width) // Did the ball pass player2?
+    {
+        this->player1_score++;
+        this->reset_player();
+        this->ball.reset(this->player1.position + glm::vec2(player_size.x, player_size.y / 2 - ball_radius), initial_ball_velocity);
+    }
+}
+
+void Simulation::process_input(const SimulationInput& input, float dt)
+{
+    const float velocity = player_velocity * dt;
+
+    // player1 movement
+    if (input.player1_up) // Up
+    {
+        if (this->player1.position.y >= 0.0f)
+        {
+            this->player1.position.y -= velocity;
+            if (this->ball.stuck && this->ball.position.x <= this->width / 2)
+                this->ball.position.y -= velocity;
+        }
+    }
+    if (input.player1_down) // Down
+    {
+        if (this->player1.position.y <= this->height - this->player1.size.y)
+        {
+            this->player1.position.y += velocity;
+            if (this->ball.stuck && this->ball.position.x <= this->width / 2)
+                this->ball.position.y += velocity;
+        }
+    }
+
+    // player2 movement
+    if (input.player2_up) // up
+    {
+        if (this->player2.position.y >= 0.0f)
+        {
+            this->player2.position.y -= velocity;
+            if (this->ball.stuck && this->ball.position.x >= this->width / 2)
+                this->ball.position.y -= velocity;
+        }
+    }
+    if (input.player2_down) // down
+    {
+        if (this->player2.position.y <= this->height - this->player2.size.y)
+        {
+            this->player2.position.y += velocity;
+            if (this->ball.stuck && this->ball.position.x >= this->width / 2)
+                this->ball.position.y += velocity;
+        }
+    }
+
+    // defines that the ball can move
+    if (input.launch)
+        this->ball.stuck = false;
+}
+
+void Simulation::reset_player()
+{
+    // reset player1 stats
+    this->player1.size = player_size;
+    this->player1.position = glm::vec2(0, this->height / 2.0f - player_size.y / 2.0f);
+    this->player1.previous_position = this->player1.position;
+
+    // reset player2 stats
+    this->player2.size = player_size;
+    this->player2.position = glm::vec2(this->width - player_size.x, this->height / 2.0f - player_size.y / 2.0f);
+    this->player2.previous_position = this->player2.position;
+}
+
+// collision detection
+bool check_collision(GameObject& one, GameObject& two);
+Collision check_collision(BallObject& one, GameObject& two);
+float sweep_collision(const BallObject& one, const GameObject& two, float max_time);
+direction vector_direction(glm::vec2 closest);
+
+void Simulation::move_ball(BallObject* ball, const float dt)
+{
+    // advance to the earliest paddle contact, bounce, and continue with the time left. The sweep ignores
+    // wall bounces inside the interval (BallObject::move handles those) and paddle motion, do_collisions covers both
+    constexpr int max_contacts = 4;
+    float remaining = dt;
+    for (int contact = 0; contact < max_contacts && remaining > 0.0f; contact++)
+    {
+        float time = remaining;
+        GameObject* hit = nullptr;
+        if (!ball->stuck)
+        {
+            for (GameObject* player : { &this->player1, &this->player2 })
+            {
+                const float impact = sweep_collision(*ball, *player, time);
+                if (impact >= 0.0f && impact < time)
+                {
+                    time = impact;
+                    hit = player;
+                }
+            }
+        }
+        ball->move(time, this->width, this->height);
+        remaining -= time;
+        if (hit == nullptr)
+            break;
+        this->bounce(ball, hit);
+    }
+}
+
+void Simulation::do_collisions(BallObject* ball, GameObject* player)
+{
+    Collision result = check_collision(*ball, *player);
+    if (!ball->stuck && std::get<0>(result)) // check collisions for player pad (unless stuck)
+        this->bounce(ball, player);
+}
+
+void Simulation::bounce(BallObject* ball, GameObject* player)
+{
+    // check where it hit the board, and change velocity based on where it hit the board
+    const float center_board = player->position.y + player->size.y / 2.0f; // Calculate the coordinate that represents the center of the racket.
+    const float distance = (ball->position.y + ball->radius) - center_board;
+    const float percentage = distance / (player->size.y / 2.0f);
+
+    // then move accordingly
+    constexpr float strength = 2.0f;
+    const glm::vec2 old_velocity = ball->velocity;
+    ball->velocity.y = initial_ball_velocity.y * percentage * strength;
+    ball->velocity = glm::normalize(ball->velocity) * glm::length(old_velocity); // keep speed consistent over both axes (multiply by length of old velocity, so total strength is not changed)
+
+    // fix sticky paddle
+    if (ball->position.x < this->width / 2) {
+        ball->velocity.x = 1.0f * std::abs(ball->velocity.x);
+    }
+    else {
+        ball->velocity.x = -1.0f * std::abs(ball->velocity.x);
+    }
+}
+
+bool check_collision(const GameObject& one, const GameObject& two) // AABB - AABB collision
+{
+    // collision x-axis?
+    const bool collision_x = one.position.x + one.size.x >= two.position.x && two.position.x + two.size.x >= one.position.x;
+    // collision y-axis?
+    const bool collision_y = one.position.y + one.size.y >= two.position.y && two.position.y + two.size.y >= one.position.y;
+    // collision only if on both axes
+    return collision_x && collision_y;
+}
+
+Collision check_collision(BallObject& one, GameObject& two) // AABB - Circle collision
+{
+    // get center point circle first 
+    glm::vec2 center(one.position + one.radius);
+    // calculate AABB info (center, half-extents)
+    glm::vec2 aabb_half_extents(two.size.x / 2.0f, two.size.y / 2.0f);
+    glm::vec2 aabb_center(two.position.x + aabb_half_extents.x, two.position.y + aabb_half_extents.y);
+    // get difference vector between both centers
+    glm::vec2 difference = center - aabb_center;
+    glm::vec2 clamped = glm::clamp(difference, -aabb_half_extents, aabb_half_extents);
+    // now that we know the clamped values, add this to AABB_center and we get the value of box closest to circle
+    glm::vec2 closest = aabb_center + clamped;
+    // now retrieve vector between center circle and closest point AABB and check if length < radius
+    difference = closest - center;
+
+    if (glm::length(difference) <= one.radius)
+        return std::make_tuple(true, vector_direction(difference), difference);
+    else
+        return std::make_tuple(false, up, glm::vec2(0.0f, 0.0f));
+}
+
+// Swept Circle - AABB collision: the time in [0, max_time] at which the moving ball first touches the box, or -1.0f
+// if it does not (or already overlaps it). The circle center moves along a ray against the box grown by the radius,
+// with the grown corners rounded
+float sweep_collision(const BallObject& one, const GameObject& two, const float max_time)
+{
+    const glm::vec2 center(one.position + one.radius);
+    const glm::vec2 box_min = two.position;
+    const glm::vec2 box_max = two.position + two.size;
+
+    // ray against the grown box, one slab per axis
+    float enter = -1.0f, exit = max_time;
+    for (int axis = 0; axis < 2; axis++)
+    {
+        const float low = box_min[axis] - one.radius;
+        const float high = box_max[axis] + one.radius;
+        if (one.velocity[axis] == 0.0f)
+        {
+            if (center[axis] < low || center[axis] > high)
+                return -1.0f;
+            continue;
+        }
+        float near_time = (low - center[axis]) / one.velocity[axis];
+        float far_time = (high - center[axis]) / one.velocity[axis];
+        if (near_time > far_time)
+            std::swap(near_time, far_time);
+        enter = std::max(enter, near_time);
+        exit = std::min(exit, far_time);
+        // touching while moving apart is not a contact
+        if (enter >= exit)
+            return -1.0f;
+    }
+    // starting inside is an overlap, not a contact
+    if (enter < 0.0f)
+        return -1.0f;
+
+    // entering through a grown corner: the real shape there is a circle around the box corner
+    const glm::vec2 point = center + one.velocity * enter;
+    const bool outside_x = point.x < box_min.x || point.x > box_max.x;
+    const bool outside_y = point.y < box_min.y || point.y > box_max.y;
+    if (outside_x && outside_y)
+    {
+        const glm::vec2 corner(point.x < box_min.x ? box_min.x : box_max.x, point.y < box_min.y ? box_min.y : box_max.y);
+        // |center + velocity * t - corner| = radius
+        const glm::vec2 offset = center - corner;
+        const float a = glm::dot(one.velocity, one.velocity);
+        const float b = glm::dot(offset, one.velocity);
+        const float c = glm::dot(offset, offset) - one.radius * one.radius;
+        const float discriminant = b * b - a * c;
+        if (discriminant < 0.0f)
+            return -1.0f;
+        enter = (-b - std::sqrt(discriminant)) / a;
+        if (enter < 0.0f || enter > max_time)
+            return -1.0f;
+    }
+    return enter;
+}
+
+// calculates which direction a vector is facing (N,E,S or W)
+direction vector_direction(glm::vec2 closest)
+{
+    constexpr glm::vec2 compass[] = {
+			  glm::vec2(0.0f, 1.0f),	// up
+			  glm::vec2(1.0f, 0.0f),	// right
+			  glm::vec2(0.0f, -1.0f),	// down
+			  glm::vec2(-1.0f, 0.0f)	// left
+    };
+    float max = 0.0f;
+    unsigned int best_match = -1;
+    for (unsigned int i = 0; i < 4; i++)
+    {
+        float dot_product = glm::dot(glm::normalize(closest), compass[i]);
+        if (dot_product > max)
+        {
+            max = dot_product;
+            best_match = i;
+        }
+    }
+    return (direction)best_match;
+}
\ No newline at end of file
@@ -0,0 +1,115 @@
+#ifndef SIMULATION_H
+#define SIMULATION_H
+
+#include <cstdint>
+#include <type_traits>
+#include "deterministic_math.h"
+#include <glm/glm.hpp>
+#include "game_object.h"
+#include "ball_object.h"
+
+// Represents the four possible (collision) directions
+enum direction {
+    up,
+    right,
+    down,
+    left
+};
+
+// Initial size of the player paddle
+constexpr glm::vec2 player_size(20.0f, 100.0f);
+// Initial velocity of the player paddle
+constexpr float player_velocity(1000.0f);
+// Initial velocity of the ball
+constexpr glm::vec2 initial_ball_velocity(1500.0f, -150.0f);
+// radius of the ball object
+constexpr float ball_radius = 12.5f;
+// default rate of the fixed-step simulation, in steps per second; independent of the render rate
+constexpr float simulation_rate = 240.0f;
+
+// Input of both players for one simulation step, independent of any window or input library
+struct SimulationInput
+{
+    bool player1_up   = false;
+    bool player1_down = false;
+    bool player2_up   = false;
+    bool player2_down = false;
+    bool launch       = false; // releases the ball stuck to a paddle
+};
+
+// SimulationInput packed into one byte, for batches and recordings
+enum input_bit {
+    input_player1_up   = 1 << 0,
+    input_player1_down = 1 << 1,
+    input_player2_up   = 1 << 2,
+    input_player2_down = 1 << 3,
+    input_launch       = 1 << 4
+};
+unsigned char   pack_input(const SimulationInput& input);
+SimulationInput unpack_input(unsigned char bits);
+
+// Everything in a Simulation that changes while it runs, as plain data without padding: saving
+// and restoring it are single copies, for rollback, AI search and replay seeking. Paddle and ball
+// sizes are constants and not part of it. Replay keyframes store it as is.
+struct SimulationState
+{
+    std::uint64_t tick;
+    std::uint64_t state_hash;
+    std::uint32_t width, height;
+    std::uint32_t player1_score, player2_score;
+    float         player1_x, player1_y, player1_previous_x, player1_previous_y;
+    float         player2_x, player2_y, player2_previous_x, player2_previous_y;
+    float         ball_x, ball_y, ball_previous_x, ball_previous_y;
+    float         ball_velocity_x, ball_velocity_y;
+    std::uint32_t stuck;
+    std::uint32_t reserved;
+};
+
+static_assert(std::is_trivially_copyable<SimulationState>::value && std::is_standard_layout<SimulationState>::value, "SimulationState must be plain data");
+static_assert(sizeof(SimulationState) == 96, "SimulationState must have no padding");
+
+// Simulation holds the rules of the game: paddles, ball, collisions, resets and score.
+// It has no GL or GLFW dependency, so it runs headless (bots, servers, tools); the game
+// window is a client that feeds it input and draws its state. Given the same inputs and
+// step lengths it is bit-exact across builds and machines (see deterministic_math.h), and
+// every step extends a hash of the state that peers and replays can compare.
+class Simulation
+{
+public:
+    // arena size
+    unsigned int width, height;
+    // game state
+    GameObject   player1, player2;
+    BallObject   ball;
+    unsigned int player1_score, player2_score;
+    // steps taken, and a rolling hash over the state after each of them
+    std::uint64_t tick;
+    std::uint64_t state_hash;
+
+    // constructor
+    Simulation(unsigned int width, unsigned int height);
+
+    // puts the paddles and the ball at their starting positions and clears the score
+    void reset();
+    // advances the simulation by one step: keeps the previous positions, then runs input and update
+    void step(const SimulationInput& input, float dt);
+    // hash of the current state alone (positions, velocities, scores, tick)
+    std::uint64_t hash_state() const;
+    // copies the whole changing state out, or back in; restoring then stepping gives the same results as the original
+    SimulationState save() const;
+    void            restore(const SimulationState& state);
+
+    // step stages
+    void process_input(const SimulationInput& input, float dt);
+    void update(float dt);
+    // moves the ball through dt, bouncing it off the paddles at the exact time of contact (no tunnelling at any speed)
+    void move_ball(BallObject* ball, float dt);
+    void do_collisions(BallObject* ball, GameObject* player);
+    // changes the ball velocity after it hit a paddle
+    void bounce(BallObject* ball, GameObject* player);
+
+    // reset
+    void reset_player();
+};
+
+#endif
\ No newline at end of file
@@ -3,8 +3,14 @@
 
 #include "game.h"
 #include "ResourceManager.h"
+#include "startup_timeline.h"
 
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
+#include <string>
+#include <vector>
 
 // GLFW function declarations
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
@@ -14,12 +20,66 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
 constexpr unsigned int SCREEN_WIDTH = 1370;
 // The height of the screen
 constexpr unsigned int SCREEN_HEIGHT = 763;
+// Longest frame time fed to the simulation; after a stall (window drag, breakpoint) the game slows down instead of
+// running hundreds of steps to catch up
+constexpr float MAX_FRAME_TIME = 0.25f;
 
 Game PingPong(SCREEN_WIDTH, SCREEN_HEIGHT);
 
 int main(int argc, char* argv[])
 {
+    StartupTimeline::begin();
+
+    // --startup-benchmark: quit after the first complete frame and write the timeline for the startup benchmark tool
+    // --tick-rate=<hz>: rate of the fixed-step simulation (default simulation_rate)
+    // --record=<file>: records the match into a replay file
+    // --replay=<file>: plays a replay file instead of reading the keys
+    // --net-port=<port> --net-peer=<host>:<port> [--net-player=<1|2>] [--input-delay=<ticks>]: rollback play over UDP
+    // --arena=<balls>: arena mode, that many balls bouncing off each other and a few obstacles
+    // --ai=<1|2> [--ai-skill=<0..1>]: the computer plays that paddle (repeat for both), at full skill by default
+    bool startupBenchmark = false;
+    float tickRate = simulation_rate;
+    const char* recordFile = nullptr;
+    const char* replayFile = nullptr;
+    unsigned short netPort = 0;
+    std::string netPeer;
+    unsigned int netPlayer = 1;
+    unsigned int inputDelay = default_input_delay;
+    unsigned int arenaBalls = 0;
+    std::vector<unsigned int> aiPlayers;
+    float aiSkill = 1.0f;
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::strcmp(argv[i], "--startup-benchmark") == 0)
+            startupBenchmark = true;
+        else if (std::strncmp(argv[i], "--tick-rate=", 12) == 0 && std::atof(argv[i] + 12) > 0.0)
+            tickRate = static_cast<float>(std::atof(argv[i] + 12));
+        else if (std::strncmp(argv[i], "--record=", 9) == 0)
+            recordFile = argv[i] + 9;
+        else if (std::strncmp(argv[i], "--replay=", 9) == 0)
+            replayFile = argv[i] + 9;
+        else if (std::strncmp(argv[i], "--net-port=", 11) == 0)
+            netPort = static_cast<unsigned short>(std::atoi(argv[i] + 11));
+        else if (std::strncmp(argv[i], "--net-peer=", 11) == 0)
+            netPeer = argv[i] + 11;
+        else if (std::strncmp(argv[i], "--net-player=", 13) == 0)
+            netPlayer = static_cast<unsigned int>(std::atoi(argv[i] + 13));
+        else if (std::strncmp(argv[i], "--input-delay=", 14) == 0)
+            inputDelay = static_cast<unsigned int>(std::atoi(argv[i] + 14));
+        else if (std::strncmp(argv[i], "--arena=", 8) == 0)
+            arenaBalls = static_cast<unsigned int>(std::atoi(argv[i] + 8));
+        else if (std::strncmp(argv[i], "--ai=", 5) == 0 && (std::atoi(argv[i] + 5) == 1 || std::atoi(argv[i] + 5) == 2))
+            aiPlayers.push_back(static_cast<unsigned int>(std::atoi(argv[i] + 5)));
+        else if (std::strncmp(argv[i], "--ai-skill=", 11) == 0)
+            aiSkill = static_cast<float>(std::atof(argv[i] + 11));
+    }
+
+    // textures decode on the worker threads while the window and the GL context are being created
+    PingPong.preload();
+    StartupTimeline::mark("preload dispatch");
+
     glfwInit();
+    StartupTimeline::mark("glfwInit");
 
     //glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
     //glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
@@ -31,6 +91,7 @@ int main(int argc, char* argv[])
 
     GLFWwindow* window = glfwCreateWindow(SCREEN_WIDTH, SCREEN_HEIGHT, "PingPong", nullptr, nullptr);
     glfwMakeContextCurrent(window);
+    StartupTimeline::mark("window and context");
 
     // glad: load all OpenGL function pointers
     // ---------------------------------------
@@ -39,6 +100,7 @@ int main(int argc, char* argv[])
         std::cout << "Failed to initialize GLAD" << std::endl;
         return -1;
     }
+    StartupTimeline::mark("gladLoadGL");
 
     glfwSetKeyCallback(window, key_callback);
     glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
@@ -52,42 +114,100 @@ int main(int argc, char* argv[])
     // initialize game
     // ---------------
     PingPong.init();
+    StartupTimeline::mark("Game::init");
 
     // deltaTime variables
     // -------------------
     float deltaTime = 0.0f;
-    float lastFrame = 0.0f;
+    double lastFrame = glfwGetTime(); // double: a float clock loses sub-step precision after a few hours
+
+    // fixed-step simulation: frame time accumulates and is consumed in whole steps
+    if (replayFile != nullptr && PingPong.play(replayFile))
+        tickRate = 1.0f / PingPong.replay.step_length;
+    const float simulationStep = 1.0f / tickRate;
+    // net play starts from a new match, so not with a replay
+    const std::size_t peerSeparator = netPeer.rfind(':');
+    const bool netplay = netPort != 0 && peerSeparator != std::string::npos && replayFile == nullptr &&
+                         PingPong.connect(netPort, netPeer.substr(0, peerSeparator).c_str(), static_cast<unsigned short>(std::atoi(netPeer.c_str() + peerSeparator + 1)),
+                                          netPlayer, inputDelay, simulationStep);
+    // a net play recording would hold predicted input, it is not made
+    if (recordFile != nullptr && replayFile == nullptr && !netplay)
+        PingPong.record(recordFile, simulationStep);
+    if (arenaBalls > 0)
+        PingPong.start_arena(arenaBalls);
+    for (const unsigned int player : aiPlayers)
+        PingPong.add_bot(player, aiSkill);
+    double lastTitleUpdate = 0.0;
+    float accumulator = 0.0f;
 
     // Orthographic projection from
     // This allows us to specify all vertex coordinates equal to the pixel coordinates
     glm::mat4 projection = glm::ortho(0.0f, 800.0f, 600.0f, 0.0f, -1.0f, 1.0f);
 
+    // startup milestones: first frame presented, first frame with every texture resident
+    bool firstFrame = true;
+    bool startupComplete = false;
+
     while (!glfwWindowShouldClose(window))
     {
         // calculate delta time
         // --------------------
-        float currentFrame = glfwGetTime();
-        deltaTime = currentFrame - lastFrame;
+        const double currentFrame = glfwGetTime();
+        deltaTime = std::min(static_cast<float>(currentFrame - lastFrame), MAX_FRAME_TIME);
         lastFrame = currentFrame;
         glfwPollEvents();
 
-        // manage user input
-        // -----------------
-        PingPong.process_input(deltaTime);
-
-        // update game state
-        // -----------------
-        PingPong.update(deltaTime);
-
-        // render
-        // ------
+        // resource bookkeeping (LRU stamps, memory budget) and background texture uploads
+        // ---------------------------------------------------------------------------------
+        ResourceManager::begin_frame();
+        ResourceManager::update_streaming();
+
+        // manage user input and update game state, in fixed steps
+        // -------------------------------------------------------
+        accumulator += deltaTime;
+        while (accumulator >= simulationStep)
+        {
+            PingPong.step(simulationStep);
+            accumulator -= simulationStep;
+        }
+
+        // render, between the last two simulated states
+        // ----------------------------------------------
         glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT);
-        PingPong.render();
+        PingPong.render(accumulator / simulationStep);
+        if (netplay && currentFrame - lastTitleUpdate > 0.5)
+        {
+            glfwSetWindowTitle(window, PingPong.net_status().c_str());
+            lastTitleUpdate = currentFrame;
+        }
 
         glfwSwapBuffers(window);
+
+        if (firstFrame)
+        {
+            StartupTimeline::mark("first frame");
+            firstFrame = false;
+        }
+        if (!startupComplete && ResourceManager::pending_texture_loads() == 0)
+        {
+            StartupTimeline::mark("first complete frame");
+            startupComplete = true;
+            StartupTimeline::print(std::cout);
+            // textures load in the background, so the load report waits for them as well
+            PingPong.report_loading();
+            if (startupBenchmark)
+            {
+                if (!StartupTimeline::write_json("startup_timeline.json"))
+                    std::cout << "ERROR::STARTUP: Failed to write startup_timeline.json" << std::endl;
+                glfwSetWindowShouldClose(window, true);
+            }
+        }
     }
 
+    // finish writing the recording
+    PingPong.recorder.close();
+
     // delete all resources as loaded using the resource manager
     // ---------------------------------------------------------
     ResourceManager::clear();
@@ -101,6 +221,9 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
     // when a user presses the escape key, we set the WindowShouldClose property to true, closing the application
     if (key == GLFW_KEY_ESCAPE && action == GLFW_PRESS)
         glfwSetWindowShouldClose(window, true);
+    // F5 reloads the textures from their files
+    if (key == GLFW_KEY_F5 && action == GLFW_PRESS)
+        PingPong.reload_textures();
     if (key >= 0 && key < 1024)
     {
         if (action == GLFW_PRESS)
@@ -10,6 +10,8 @@
 
 #include <glad/glad.h>
 
+#include "ResourceManager.h"
+
 // It was "SpriteRenderer::SpriteRenderer(Shader& Shader)"
 SpriteRenderer::SpriteRenderer(const Shader shader)
 {
@@ -41,6 +43,8 @@ void SpriteRenderer::draw_sprite(Texture2D texture, glm::vec2 position, glm::vec
     // render textured quad
     this->shader_.set_vector_3_f("spriteColor", color);
 
+    // keep the texture resident (and bring it back if the resource budget evicted it)
+    ResourceManager::touch_texture(texture.id);
     glActiveTexture(GL_TEXTURE0);
     texture.bind();
 
@@ -0,0 +1,47 @@
+#include "startup_timeline.h"
+
+#include <fstream>
+#include <iomanip>
+
+std::chrono::steady_clock::time_point StartupTimeline::start_;
+std::vector<StartupPhase>             StartupTimeline::phases_;
+
+
+void StartupTimeline::begin()
+{
+    start_ = std::chrono::steady_clock::now();
+    phases_.clear();
+}
+
+void StartupTimeline::mark(const char* phase)
+{
+    const double at = elapsed();
+    const double previous = phases_.empty() ? 0.0 : phases_.back().at;
+    phases_.push_back({ phase, at - previous, at });
+}
+
+double StartupTimeline::elapsed()
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start_).count();
+}
+
+void StartupTimeline::print(std::ostream& out)
+{
+    const std::ios::fmtflags flags = out.flags();
+    out << std::fixed << std::setprecision(2) << "Startup timeline" << std::endl;
+    for (const StartupPhase& phase : phases_)
+        out << "  " << std::left << std::setw(24) << phase.name << std::right << std::setw(10) << phase.seconds * 1000.0 << " ms  (at " << phase.at * 1000.0 << " ms)" << std::endl;
+    out.flags(flags);
+}
+
+bool StartupTimeline::write_json(const char* file)
+{
+    std::ofstream out(file, std::ios::trunc);
+    if (!out)
+        return false;
+    out << "{\n  \"phases\": [";
+    for (std::size_t i = 0; i < phases_.size(); i++)
+        out << (i > 0 ? ",\n" : "\n") << "    { \"name\": \"" << phases_[i].name << "\", \"ms\": " << phases_[i].seconds * 1000.0 << ", \"at_ms\": " << phases_[i].at * 1000.0 << " }";
+    out << "\n  ]\n}\n";
+    return static_cast<bool>(out);
+}
\ No newline at end of file
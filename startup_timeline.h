@@ -0,0 +1,39 @@
+#ifndef STARTUP_TIMELINE_H
+#define STARTUP_TIMELINE_H
+
+#include <chrono>
+#include <ostream>
+#include <string>
+#include <vector>
+
+
+// One step of the startup sequence
+struct StartupPhase
+{
+    std::string name;
+    double      seconds; // duration of the phase (since the previous mark)
+    double      at;      // seconds since begin() when the phase ended
+};
+
+// A static recorder of the startup critical path, from main() to the first frames.
+// Only meant to be used from the main thread.
+class StartupTimeline
+{
+public:
+    // starts the clock; call first thing in main()
+    static void   begin();
+    // ends the current phase under the given name and starts the next one
+    static void   mark(const char* phase);
+    // seconds since begin()
+    static double elapsed();
+    // prints every phase with its duration and end time
+    static void   print(std::ostream& out);
+    // writes the phases as JSON, read by the startup benchmark tool; returns false if the file cannot be written
+    static bool   write_json(const char* file);
+private:
+    StartupTimeline() = default;
+    static std::chrono::steady_clock::time_point start_;
+    static std::vector<StartupPhase>             phases_;
+};
+
+#endif
\ No newline at end of file
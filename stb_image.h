@@ -268,6 +268,11 @@ RECENT REVISION HISTORY:
 // (at least this is true for iOS and Android). Therefore, the NEON support is
 // toggled by a build flag: define STBI_NEON to get NEON loops.
 //
+// The PNG decoder also uses SSE2 to reverse the Up, Sub, Avg and Paeth
+// scanline filters of 8-bit RGB/RGBA images. Define STBI_PNG_VERIFY_SIMD
+// to recompute every such scanline with the generic C code and assert that
+// both agree (slow, for testing only).
+//
 // If for some reason you do not want to use any of SIMD code, or if
 // you have issues compiling it, you can disable it entirely by
 // defining STBI_NO_SIMD.
@@ -522,6 +527,13 @@ STBIDEF void stbi_set_unpremultiply_on_load_thread(int flag_true_if_should_unpre
 STBIDEF void stbi_convert_iphone_png_to_rgb_thread(int flag_true_if_should_convert);
 STBIDEF void stbi_set_flip_vertically_on_load_thread(int flag_true_if_should_flip);
 
+// optional parallel-for used by the JPEG decoder: baseline JPEGs with restart
+// markers decoded from memory have their restart intervals decoded concurrently.
+// fn must call task(data, i) once for every i in [0, count) (from any threads)
+// and return only after all calls have finished
+typedef void stbi_parallel_for(void *user, int count, void (*task)(void *data, int index), void *data);
+STBIDEF void stbi_set_parallel_for(stbi_parallel_for *fn, void *user);
+
 // ZLIB client - used by PNG, available for other purposes
 
 STBIDEF char *stbi_zlib_decode_malloc_guesssize(const char *buffer, int len, int initial_size, int *outlen);
@@ -1109,6 +1121,15 @@ static float   *stbi__ldr_to_hdr(stbi_uc *data, int x, int y, int comp);
 static stbi_uc *stbi__hdr_to_ldr(float   *data, int x, int y, int comp);
 #endif
 
+static stbi_parallel_for *stbi__parallel_for = NULL;
+static void *stbi__parallel_for_user = NULL;
+
+STBIDEF void stbi_set_parallel_for(stbi_parallel_for *fn, void *user)
+{
+   stbi__parallel_for = fn;
+   stbi__parallel_for_user = user;
+}
+
 static int stbi__vertically_flip_on_load_global = 0;
 
 STBIDEF void stbi_set_flip_vertically_on_load(int flag_true_if_should_flip)
@@ -2944,9 +2965,130 @@ static void stbi__jpeg_reset(stbi__jpeg *j)
    // since we don't even allow 1<<30 pixels
 }
 
+// decodes MCUs [first, first+count) of a baseline scan, without restart handling
+static int stbi__jpeg_decode_mcus(stbi__jpeg *z, int first, int count)
+{
+   STBI_SIMD_ALIGN(short, data[64]);
+   int m;
+   for (m = first; m < first + count; ++m) {
+      if (z->scan_n == 1) {
+         // non-interleaved: every block is an MCU, in scanline order
+         int n = z->order[0];
+         int w = (z->img_comp[n].x+7) >> 3;
+         int i = m % w, j = m / w;
+         int ha = z->img_comp[n].ha;
+         if (!stbi__jpeg_decode_block(z, data, z->huff_dc+z->img_comp[n].hd, z->huff_ac+ha, z->fast_ac[ha], n, z->dequant[z->img_comp[n].tq])) return 0;
+         z->idct_block_kernel(z->img_comp[n].data+z->img_comp[n].w2*j*8+i*8, z->img_comp[n].w2, data);
+      } else {
+         int i = m % z->img_mcu_x, j = m / z->img_mcu_x;
+         int k,x,y;
+         for (k=0; k < z->scan_n; ++k) {
+            int n = z->order[k];
+            for (y=0; y < z->img_comp[n].v; ++y) {
+               for (x=0; x < z->img_comp[n].h; ++x) {
+                  int x2 = (i*z->img_comp[n].h + x)*8;
+                  int y2 = (j*z->img_comp[n].v + y)*8;
+                  int ha = z->img_comp[n].ha;
+                  if (!stbi__jpeg_decode_block(z, data, z->huff_dc+z->img_comp[n].hd, z->huff_ac+ha, z->fast_ac[ha], n, z->dequant[z->img_comp[n].tq])) return 0;
+                  z->idct_block_kernel(z->img_comp[n].data+z->img_comp[n].w2*y2+x2, z->img_comp[n].w2, data);
+               }
+            }
+         }
+      }
+   }
+   return 1;
+}
+
+// restart intervals of one scan, split between parallel tasks
+typedef struct
+{
+   stbi__jpeg *z;
+   stbi_uc **interval_start; // interval_count+1 entries, the last one is the marker ending the scan
+   int interval_count;
+   int mcu_count;
+   int task_count; // at most 64
+   int failed[64]; // one flag per task, each written only by its own task and read after the join
+} stbi__jpeg_intervals;
+
+static void stbi__jpeg_decode_interval_task(void *data, int task)
+{
+   stbi__jpeg_intervals *iv = (stbi__jpeg_intervals *) data;
+   stbi__jpeg *z = (stbi__jpeg *) stbi__malloc(sizeof(stbi__jpeg));
+   stbi__context s;
+   int first = iv->interval_count * task / iv->task_count;
+   int last  = iv->interval_count * (task+1) / iv->task_count;
+   int k;
+   if (!z) { iv->failed[task] = 1; return; }
+   // private decoder state; tables and output buffers are shared read-only / written disjointly
+   *z = *iv->z;
+   s = *iv->z->s;
+   z->s = &s;
+   for (k = first; k < last && !iv->failed[task]; ++k) {
+      int mcu = k * z->restart_interval;
+      int count = iv->mcu_count - mcu < z->restart_interval ? iv->mcu_count - mcu : z->restart_interval;
+      // each interval's data runs up to and including the marker after it
+      s.img_buffer = iv->interval_start[k];
+      s.img_buffer_end = iv->interval_start[k+1] + (k+1 < iv->interval_count ? 0 : 2);
+      stbi__jpeg_reset(z);
+      if (!stbi__jpeg_decode_mcus(z, mcu, count)) iv->failed[task] = 1;
+   }
+   STBI_FREE(z);
+}
+
+// decodes a baseline scan interval by interval on stbi__parallel_for. returns -1
+// (having consumed nothing) when the scan cannot be split, so the caller decodes it serially
+static int stbi__parse_entropy_coded_data_parallel(stbi__jpeg *z)
+{
+   stbi__jpeg_intervals iv;
+   stbi_uc *p = z->s->img_buffer, *end = z->s->img_buffer_end;
+   int found = 0, failed = 0, k;
+   if (z->scan_n == 1) {
+      int n = z->order[0];
+      iv.mcu_count = ((z->img_comp[n].x+7) >> 3) * ((z->img_comp[n].y+7) >> 3);
+   } else {
+      iv.mcu_count = z->img_mcu_x * z->img_mcu_y;
+   }
+   iv.interval_count = (iv.mcu_count + z->restart_interval - 1) / z->restart_interval;
+   if (iv.interval_count < 2) return -1;
+   iv.interval_start = (stbi_uc **) stbi__malloc_mad2(iv.interval_count + 1, sizeof(stbi_uc *), 0);
+   if (!iv.interval_start) return -1;
+   // find the restart markers; the entropy-coded data ends at the first other marker
+   iv.interval_start[found++] = p;
+   while (p + 1 < end) {
+      if (p[0] != 0xff || p[1] == 0x00 || p[1] == 0xff) { ++p; continue; }
+      if (STBI__RESTART(p[1]) && found < iv.interval_count) {
+         iv.interval_start[found++] = p + 2;
+         p += 2;
+         continue;
+      }
+      break;
+   }
+   if (found != iv.interval_count || p + 1 >= end) {
+      STBI_FREE(iv.interval_start);
+      return -1;
+   }
+   iv.interval_start[found] = p;
+   iv.z = z;
+   iv.task_count = iv.interval_count < 64 ? iv.interval_count : 64;
+   memset(iv.failed, 0, sizeof(iv.failed));
+   stbi__parallel_for(stbi__parallel_for_user, iv.task_count, stbi__jpeg_decode_interval_task, &iv);
+   STBI_FREE(iv.interval_start);
+   for (k = 0; k < iv.task_count; ++k)
+      failed |= iv.failed[k];
+   if (failed) return stbi__err("bad huffman code","Corrupt JPEG");
+   // continue after the scan, the caller picks up the marker that ends it
+   z->s->img_buffer = p;
+   z->marker = STBI__MARKER_none;
+   return 1;
+}
+
 static int stbi__parse_entropy_coded_data(stbi__jpeg *z)
 {
    stbi__jpeg_reset(z);
+   if (!z->progressive && z->restart_interval && stbi__parallel_for && !z->s->read_from_callbacks) {
+      int r = stbi__parse_entropy_coded_data_parallel(z);
+      if (r >= 0) return r;
+   }
    if (!z->progressive) {
       if (z->scan_n == 1) {
          int i,j;
@@ -4326,8 +4468,14 @@ static int stbi__parse_huffman_block(stbi__zbuf *a)
          }
          p = (stbi_uc *) (zout - dist);
          if (dist == 1) { // run of one byte; common in images.
-            stbi_uc v = *p;
-            if (len) { do *zout++ = v; while (--len); }
+            memset(zout, *p, len);
+            zout += len;
+         } else if (dist >= 8 && zout + len + 8 <= a->zout_end) {
+            // copy 8 bytes at a time. a chunk never reads bytes it writes since dist >= 8,
+            // and the last one may run up to 7 bytes past the match (still inside the buffer)
+            char *end = zout + len;
+            do { memcpy(zout, p, 8); zout += 8; p += 8; } while (zout < end);
+            zout = end;
          } else {
             if (len) { do *zout++ = *p++; while (--len); }
          }
@@ -4644,6 +4792,135 @@ static int stbi__paeth(int a, int b, int c)
    return c;
 }
 
+#ifdef STBI_SSE2
+// SSE2 versions of the scanline filters for 8-bit images with 3 or 4 bytes per pixel.
+// cur, raw and prior point past the first pixel (cur[-bpp] and prior[-bpp] are valid);
+// n is the number of bytes left in the row. returns 0 for filters handled elsewhere.
+// 3-byte pixels are assembled in a register; going through memory would stall store forwarding
+stbi_inline static __m128i stbi__png_load_pixel(const stbi_uc *p, int bpp)
+{
+   int v;
+   if (bpp == 4) memcpy(&v, p, 4);
+   else          v = p[0] | (p[1] << 8) | (p[2] << 16);
+   return _mm_cvtsi32_si128(v);
+}
+
+stbi_inline static void stbi__png_store_pixel(stbi_uc *p, __m128i v, int bpp)
+{
+   int x = _mm_cvtsi128_si32(v);
+   if (bpp == 4) memcpy(p, &x, 4);
+   else {
+      p[0] = (stbi_uc) x;
+      p[1] = (stbi_uc) (x >> 8);
+      p[2] = (stbi_uc) (x >> 16);
+   }
+}
+
+stbi_inline static int stbi__png_unfilter_row_sse2(int filter, stbi_uc *cur, const stbi_uc *raw, const stbi_uc *prior, int n, int bpp)
+{
+   __m128i zero = _mm_setzero_si128();
+   int k = 0;
+   switch (filter) {
+      case STBI__F_up:
+         // no dependency between bytes, 16 at a time
+         for (; k + 16 <= n; k += 16)
+            _mm_storeu_si128((__m128i *) (cur+k), _mm_add_epi8(_mm_loadu_si128((const __m128i *) (raw+k)), _mm_loadu_si128((const __m128i *) (prior+k))));
+         for (; k < n; ++k)
+            cur[k] = STBI__BYTECAST(raw[k] + prior[k]);
+         return 1;
+      case STBI__F_sub: {
+         __m128i left = stbi__png_load_pixel(cur-bpp, bpp);
+         if (bpp == 4) {
+            // prefix sum of four pixels in one register
+            left = _mm_shuffle_epi32(left, 0);
+            for (; k + 16 <= n; k += 16) {
+               __m128i x = _mm_loadu_si128((const __m128i *) (raw+k));
+               x = _mm_add_epi8(x, _mm_slli_si128(x, 4));
+               x = _mm_add_epi8(x, _mm_slli_si128(x, 8));
+               x = _mm_add_epi8(x, left);
+               _mm_storeu_si128((__m128i *) (cur+k), x);
+               left = _mm_shuffle_epi32(x, _MM_SHUFFLE(3,3,3,3));
+            }
+         }
+         for (; k < n; k += bpp) {
+            left = _mm_add_epi8(stbi__png_load_pixel(raw+k, bpp), left);
+            stbi__png_store_pixel(cur+k, left, bpp);
+         }
+         return 1;
+      }
+      case STBI__F_avg: {
+         __m128i one = _mm_set1_epi8(1);
+         __m128i left = stbi__png_load_pixel(cur-bpp, bpp);
+         for (; k < n; k += bpp) {
+            __m128i up = stbi__png_load_pixel(prior+k, bpp);
+            // _mm_avg_epu8 rounds up, the filter rounds down
+            __m128i avg = _mm_sub_epi8(_mm_avg_epu8(left, up), _mm_and_si128(_mm_xor_si128(left, up), one));
+            left = _mm_add_epi8(stbi__png_load_pixel(raw+k, bpp), avg);
+            stbi__png_store_pixel(cur+k, left, bpp);
+         }
+         return 1;
+      }
+      case STBI__F_paeth: {
+         // branchless predictor in 16-bit lanes: p - a = b - c, p - b = a - c, p - c = (b - c) + (a - c)
+         __m128i a = _mm_unpacklo_epi8(stbi__png_load_pixel(cur-bpp, bpp), zero);
+         __m128i c = _mm_unpacklo_epi8(stbi__png_load_pixel(prior-bpp, bpp), zero);
+         for (; k < n; k += bpp) {
+            __m128i b = _mm_unpacklo_epi8(stbi__png_load_pixel(prior+k, bpp), zero);
+            __m128i pa = _mm_sub_epi16(b, c);
+            __m128i pb = _mm_sub_epi16(a, c);
+            __m128i pc = _mm_add_epi16(pa, pb);
+            __m128i smallest, pred;
+            pa = _mm_max_epi16(pa, _mm_sub_epi16(zero, pa));
+            pb = _mm_max_epi16(pb, _mm_sub_epi16(zero, pb));
+            pc = _mm_max_epi16(pc, _mm_sub_epi16(zero, pc));
+            smallest = _mm_min_epi16(pc, _mm_min_epi16(pa, pb));
+            // a if pa is smallest, else b if pb is, else c (the tie order of stbi__paeth)
+            pred = _mm_cmpeq_epi16(smallest, pb);
+            pred = _mm_or_si128(_mm_and_si128(pred, b), _mm_andnot_si128(pred, c));
+            {
+               __m128i use_a = _mm_cmpeq_epi16(smallest, pa);
+               pred = _mm_or_si128(_mm_and_si128(use_a, a), _mm_andnot_si128(use_a, pred));
+            }
+            a = _mm_unpacklo_epi8(_mm_add_epi8(stbi__png_load_pixel(raw+k, bpp), _mm_packus_epi16(pred, pred)), zero);
+            stbi__png_store_pixel(cur+k, _mm_packus_epi16(a, a), bpp);
+            c = b;
+         }
+         return 1;
+      }
+   }
+   return 0;
+}
+
+// instantiates the kernels for a constant pixel size
+static int stbi__png_unfilter_row_simd(int filter, stbi_uc *cur, const stbi_uc *raw, const stbi_uc *prior, int n, int bpp)
+{
+   if (bpp == 4) return stbi__png_unfilter_row_sse2(filter, cur, raw, prior, n, 4);
+   else          return stbi__png_unfilter_row_sse2(filter, cur, raw, prior, n, 3);
+}
+
+#ifdef STBI_PNG_VERIFY_SIMD
+// recomputes a scanline unfiltered by stbi__png_unfilter_row_sse2 with the generic code
+static void stbi__png_verify_row(int filter, const stbi_uc *cur, const stbi_uc *raw, const stbi_uc *prior, int n, int bpp)
+{
+   stbi_uc *check = (stbi_uc *) stbi__malloc(n + bpp);
+   int k;
+   if (!check) return;
+   memcpy(check, cur-bpp, bpp);
+   for (k=0; k < n; ++k) {
+      stbi_uc *out = check + bpp;
+      switch (filter) {
+         case STBI__F_sub:   out[k] = STBI__BYTECAST(raw[k] + out[k-bpp]); break;
+         case STBI__F_up:    out[k] = STBI__BYTECAST(raw[k] + prior[k]); break;
+         case STBI__F_avg:   out[k] = STBI__BYTECAST(raw[k] + ((prior[k] + out[k-bpp])>>1)); break;
+         case STBI__F_paeth: out[k] = STBI__BYTECAST(raw[k] + stbi__paeth(out[k-bpp],prior[k],prior[k-bpp])); break;
+      }
+   }
+   STBI_ASSERT(memcmp(check + bpp, cur, n) == 0);
+   STBI_FREE(check);
+}
+#endif
+#endif // STBI_SSE2
+
 static const stbi_uc stbi__depth_scale_table[9] = { 0, 0xff, 0x55, 0, 0x11, 0,0,0, 0x01 };
 
 // create the png data from post-deflated data
@@ -4731,6 +5008,13 @@ static int stbi__create_png_image_raw(stbi__png *a, stbi_uc *raw, stbi__uint32 r
          #define STBI__CASE(f) \
              case f:     \
                 for (k=0; k < nk; ++k)
+         #ifdef STBI_SSE2
+         if (depth == 8 && (filter_bytes == 3 || filter_bytes == 4) && stbi__png_unfilter_row_simd(filter, cur, raw, prior, nk, filter_bytes)) {
+            #ifdef STBI_PNG_VERIFY_SIMD
+            stbi__png_verify_row(filter, cur, raw, prior, nk, filter_bytes);
+            #endif
+         } else
+         #endif
          switch (filter) {
             // "none" filter turns into a memcpy here; make that explicit.
             case STBI__F_none:         memcpy(cur, raw, nk); break;
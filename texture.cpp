@@ -8,31 +8,163 @@
 ******************************************************************/
 #include "texture.h"
 
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <vector>
+
 #include <glad/glad.h>
 
+#include "compressed_texture.h"
+#include "mipmap.h"
+
+// GL_EXT_texture_filter_anisotropic (core since 4.6, not part of our 3.3 loader)
+#define GL_TEXTURE_MAX_ANISOTROPY     0x84FE
+#define GL_MAX_TEXTURE_MAX_ANISOTROPY 0x84FF
+
+// returns the largest anisotropy the driver supports, or 1 if the extension is missing
+static float max_supported_anisotropy()
+{
+    static float max_anisotropy = -1.0f;
+    if (max_anisotropy < 0.0f)
+    {
+        max_anisotropy = 1.0f;
+        int count = 0;
+        glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+        for (int i = 0; i < count; i++)
+        {
+            const char* name = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i));
+            if (std::strcmp(name, "GL_EXT_texture_filter_anisotropic") == 0 || std::strcmp(name, "GL_ARB_texture_filter_anisotropic") == 0)
+            {
+                glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY, &max_anisotropy);
+                break;
+            }
+        }
+    }
+    return max_anisotropy;
+}
+
 
 Texture2D::Texture2D()
-    : width(0), height(0), internal_format(GL_RGB), image_format(GL_RGB), wrap_s(GL_REPEAT), wrap_t(GL_REPEAT), filter_min(GL_LINEAR), filter_max(GL_LINEAR)
+    : width(0), height(0), mip_levels(0), internal_format(GL_RGB), image_format(GL_RGB), wrap_s(GL_REPEAT), wrap_t(GL_REPEAT), filter_min(GL_LINEAR), filter_max(GL_LINEAR), anisotropy(1.0f)
 {
     glGenTextures(1, &this->id);
 }
 
-void Texture2D::generate(unsigned int width, unsigned int height, unsigned char* data)
+void Texture2D::generate(unsigned int width, unsigned int height, const unsigned char* data, unsigned int mip_levels)
 {
     this->width = width;
     this->height = height;
-    // create Texture
+    this->mip_levels = mip_levels;
+    // create Texture (rows of decoded images are tightly packed)
     glBindTexture(GL_TEXTURE_2D, this->id);
-    glTexImage2D(GL_TEXTURE_2D, 0, this->internal_format, width, height, 0, this->image_format, GL_UNSIGNED_BYTE, data);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    const unsigned int channels = this->image_format == GL_RGBA ? 4 : 3;
+    for (unsigned int level = 0; level < mip_levels; level++)
+    {
+        glTexImage2D(GL_TEXTURE_2D, level, this->internal_format, width, height, 0, this->image_format, GL_UNSIGNED_BYTE, data);
+        if (data != nullptr)
+            data += static_cast<size_t>(width) * height * channels;
+        width = width > 1 ? width / 2 : 1;
+        height = height > 1 ? height / 2 : 1;
+    }
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, mip_levels - 1);
     // set Texture wrap and filter modes
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, this->wrap_s);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, this->wrap_t);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, this->filter_min);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, this->filter_max);
+    if (this->anisotropy > 1.0f)
+        glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAX_ANISOTROPY, std::min(this->anisotropy, max_supported_anisotropy()));
     // unbind texture
     glBindTexture(GL_TEXTURE_2D, 0);
 }
 
+void Texture2D::generate_compressed(unsigned int width, unsigned int height, unsigned int format, const unsigned char* data, unsigned int mip_levels)
+{
+    this->width = width;
+    this->height = height;
+    this->mip_levels = mip_levels;
+    this->internal_format = format;
+    glBindTexture(GL_TEXTURE_2D, this->id);
+    for (unsigned int level = 0; level < mip_levels; level++)
+    {
+        const std::size_t size = compressed_image_size(format, width, height);
+        glCompressedTexImage2D(GL_TEXTURE_2D, level, format, width, height, 0, static_cast<GLsizei>(size), data);
+        data += size;
+        width = width > 1 ? width / 2 : 1;
+        height = height > 1 ? height / 2 : 1;
+    }
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, mip_levels - 1);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, this->wrap_s);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, this->wrap_t);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, this->filter_min);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, this->filter_max);
+    if (this->anisotropy > 1.0f)
+        glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAX_ANISOTROPY, std::min(this->anisotropy, max_supported_anisotropy()));
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+bool Texture2D::supports_compressed_format(unsigned int format)
+{
+    // the driver lists every compressed format it accepts for glCompressedTexImage2D
+    static std::vector<int> formats;
+    if (formats.empty())
+    {
+        int count = 0;
+        glGetIntegerv(GL_NUM_COMPRESSED_TEXTURE_FORMATS, &count);
+        formats.resize(count > 0 ? count : 1, 0);
+        if (count > 0)
+            glGetIntegerv(GL_COMPRESSED_TEXTURE_FORMATS, formats.data());
+    }
+    return std::find(formats.begin(), formats.end(), static_cast<int>(format)) != formats.end();
+}
+
+void Texture2D::generate_mipmaps()
+{
+    glBindTexture(GL_TEXTURE_2D, this->id);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 1000);
+    glGenerateMipmap(GL_TEXTURE_2D);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    this->mip_levels = mip_level_count(this->width, this->height);
+}
+
+void Texture2D::release_storage()
+{
+    // 0x0 levels let the driver drop the image memory of the whole mip chain; the object and its parameters stay valid
+    glBindTexture(GL_TEXTURE_2D, this->id);
+    for (unsigned int level = 0; level < std::max(this->mip_levels, 1u); level++)
+        glTexImage2D(GL_TEXTURE_2D, level, GL_RGBA, 0, 0, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    this->mip_levels = 0;
+}
+
+std::size_t Texture2D::memory_size() const
+{
+    std::size_t size = 0;
+    unsigned int width = this->width, height = this->height;
+    for (unsigned int level = 0; level < this->mip_levels; level++)
+    {
+        // drivers store RGB textures padded to four bytes per texel
+        if (compressed_block_size(this->internal_format) != 0)
+            size += compressed_image_size(this->internal_format, width, height);
+        else
+            size += static_cast<std::size_t>(width) * height * 4;
+        width = width > 1 ? width / 2 : 1;
+        height = height > 1 ? height / 2 : 1;
+    }
+    return size;
+}
+
+void Texture2D::update(unsigned int width, unsigned int height, const unsigned char* data)
+{
+    glBindTexture(GL_TEXTURE_2D, this->id);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, this->image_format, GL_UNSIGNED_BYTE, data);
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
 void Texture2D::bind() const
 {
     glBindTexture(GL_TEXTURE_2D, this->id);
@@ -9,6 +9,24 @@
 #ifndef TEXTURE_H
 #define TEXTURE_H
 
+#include <cstddef>
+
+// Where the mip chain of a texture comes from
+enum mipmap_source {
+    mipmaps_none,   // single level
+    mipmaps_gpu,    // glGenerateMipmap after upload
+    mipmaps_box,    // 2x2 box filter on the CPU at load time
+    mipmaps_kaiser  // Kaiser-windowed sinc on the CPU at load time (sharpest)
+};
+
+// Per-texture sampling settings applied at load time
+struct TextureSettings
+{
+    mipmap_source mipmaps = mipmaps_none;
+    bool          smooth = true;       // linear (true) or nearest (false) filtering
+    float         anisotropy = 1.0f;   // maximum anisotropic filtering ratio (1 = off), clamped to what the driver supports
+};
+
 // Texture2D is able to store and configure a texture in OpenGL.
 // It also hosts utility functions for easy management.
 class Texture2D
@@ -18,6 +36,7 @@ public:
     unsigned int id;
     // texture image dimensions
     unsigned int width, height; // width and height of loaded image in pixels
+    unsigned int mip_levels; // number of levels with storage (0 once the storage has been released)
     // texture Format
     unsigned int internal_format; // format of texture object
     unsigned int image_format; // format of loaded image
@@ -26,10 +45,23 @@ public:
     unsigned int wrap_t; // wrapping mode on T axis
     unsigned int filter_min; // filtering mode if texture pixels < screen pixels
     unsigned int filter_max; // filtering mode if texture pixels > screen pixels
+    float anisotropy; // maximum anisotropic filtering ratio (1 = off)
     // constructor (sets default texture modes)
     Texture2D();
-    // generates texture from image data
-    void generate(unsigned int width, unsigned int height, unsigned char* data);
+    // generates texture from image data. data may hold a tightly packed mip chain of mip_levels images, each half the size of the previous one
+    void generate(unsigned int width, unsigned int height, const unsigned char* data, unsigned int mip_levels = 1);
+    // generates texture from block-compressed data (a tightly packed chain of mip_levels images in the given compressed format)
+    void generate_compressed(unsigned int width, unsigned int height, unsigned int format, const unsigned char* data, unsigned int mip_levels);
+    // true if the driver can sample the given compressed format
+    static bool supports_compressed_format(unsigned int format);
+    // builds the mip chain from level 0 on the GPU
+    void generate_mipmaps();
+    // replaces the whole image of an already generated texture (level 0); with a pixel unpack buffer bound, data is an offset into it
+    void update(unsigned int width, unsigned int height, const unsigned char* data);
+    // frees the image storage but keeps the texture object (and its id) alive, so it can be filled again later
+    void release_storage();
+    // estimated GPU memory used by the texture's storage, in bytes
+    std::size_t memory_size() const;
     // binds the texture as the current active GL_TEXTURE_2D texture object
     void bind() const;
 };
@@ -0,0 +1,100 @@
+#include "thread_pool.h"
+
+
+ThreadPool::ThreadPool(unsigned int thread_count)
+    : stopping_(false)
+{
+    if (thread_count == 0)
+        thread_count = 1;
+    for (unsigned int i = 0; i < thread_count; i++)
+        this->workers_.emplace_back(&ThreadPool::worker_loop, this);
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(this->mutex_);
+        this->stopping_ = true;
+    }
+    this->job_available_.notify_all();
+    for (std::thread& worker : this->workers_)
+        worker.join();
+}
+
+void ThreadPool::submit(std::function<void()> job)
+{
+    {
+        std::lock_guard<std::mutex> lock(this->mutex_);
+        this->jobs_.push(std::move(job));
+    }
+    this->job_available_.notify_one();
+}
+
+void ThreadPool::parallel_for(unsigned int count, const std::function<void(unsigned int)>& job)
+{
+    if (count == 0)
+        return;
+    // shared with the helper jobs, which may only get to run after this call has returned
+    struct ParallelFor
+    {
+        std::function<void(unsigned int)> job;
+        unsigned int                      count;
+        std::atomic<unsigned int>         next;
+        std::atomic<unsigned int>         done;
+        std::mutex                        mutex;
+        std::condition_variable           finished;
+    };
+    std::shared_ptr<ParallelFor> state = std::make_shared<ParallelFor>();
+    state->job = job;
+    state->count = count;
+    state->next = 0;
+    state->done = 0;
+    auto run = [state]
+    {
+        for (unsigned int index = state->next++; index < state->count; index = state->next++)
+        {
+            state->job(index);
+            if (++state->done == state->count)
+            {
+                std::lock_guard<std::mutex> lock(state->mutex);
+                state->finished.notify_all();
+            }
+        }
+    };
+    const unsigned int helpers = count - 1 < this->size() ? count - 1 : this->size();
+    for (unsigned int i = 0; i < helpers; i++)
+        this->submit(run);
+    run();
+    // indices taken by helpers may still be running
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->finished.wait(lock, [&state] { return state->done == state->count; });
+}
+
+unsigned int ThreadPool::size() const
+{
+    return static_cast<unsigned int>(this->workers_.size());
+}
+
+ThreadPool& ThreadPool::shared()
+{
+    static ThreadPool pool(std::thread::hardware_concurrency() > 1 ? std::thread::hardware_concurrency() - 1 : 1);
+    return pool;
+}
+
+void ThreadPool::worker_loop()
+{
+    for (;;)
+    {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock(this->mutex_);
+            this->job_available_.wait(lock, [this] { return this->stopping_ || !this->jobs_.empty(); });
+            // drain the queue before stopping so no submitted job is lost
+            if (this->jobs_.empty())
+                return;
+            job = std::move(this->jobs_.front());
+            this->jobs_.pop();
+        }
+        job();
+    }
+}
\ No newline at end of file
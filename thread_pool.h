@@ -0,0 +1,44 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+
+// Fixed-size pool of worker threads that execute submitted jobs
+// in FIFO order. Jobs must not touch OpenGL state: the GL context
+// is only current on the main thread.
+class ThreadPool
+{
+public:
+    // constructor/destructor (destructor finishes queued jobs, then joins all workers)
+    explicit ThreadPool(unsigned int thread_count);
+    ~ThreadPool();
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+    // queues a job to be run on one of the workers
+    void         submit(std::function<void()> job);
+    // runs job(0) .. job(count - 1) spread over the workers and the calling thread and returns when all have finished.
+    // the caller works through the indices itself, so this may be called from inside a job of the same pool
+    void         parallel_for(unsigned int count, const std::function<void(unsigned int)>& job);
+    // number of worker threads
+    unsigned int size() const;
+    // shared pool used for background asset work, sized to the machine (one core is left for the main thread)
+    static ThreadPool& shared();
+private:
+    std::vector<std::thread>          workers_;
+    std::queue<std::function<void()>> jobs_;
+    std::mutex                        mutex_;
+    std::condition_variable           job_available_;
+    bool                              stopping_;
+    // pops and runs jobs until the pool is stopped
+    void worker_loop();
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,45 @@
+// Arena benchmark: steps the multi-ball arena headless and reports the time per step, the physics core
+// benchmark. The arena grows with the ball count so the density matches 2000 balls on the game screen.
+// Links only arena, entity_store and entity_systems.
+//
+// usage: arena_benchmark [balls] [steps]
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+
+#include "arena.h"
+
+static int print_usage()
+{
+    std::cout << "usage: arena_benchmark [balls] [steps]" << std::endl;
+    return 1;
+}
+
+int main(int argc, char* argv[])
+{
+    long long balls = 100000, steps = 1000;
+    if (argc > 3 || (argc > 1 && (balls = std::atoll(argv[1])) <= 0) || (argc > 2 && (steps = std::atoll(argv[2])) <= 0))
+        return print_usage();
+
+    const double scale = std::sqrt(balls / 2000.0);
+    Arena arena(static_cast<unsigned int>(1370 * scale), static_cast<unsigned int>(763 * scale));
+    arena.populate(static_cast<unsigned int>(balls), 4.0f);
+    const float dt = 1.0f / 240.0f;
+
+    unsigned long long tested = 0, contacts = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (long long i = 0; i < steps; i++)
+    {
+        arena.step(dt);
+        tested += arena.collisions.tested_pairs;
+        contacts += arena.collisions.contacts;
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << balls << " balls in " << arena.width << "x" << arena.height << ", " << steps << " steps in " << seconds << " s: "
+              << seconds / steps * 1000.0 << " ms per step, " << steps / seconds << " steps per second" << std::endl;
+    std::cout << "candidate pairs per step " << tested / steps << " (all pairs " << balls * (balls - 1) / 2 << "), contacts per step "
+              << contacts / steps << std::endl;
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,88 @@
+// Offline asset embedder: turns files into constexpr byte arrays that are compiled into the game,
+// so it starts without reading anything from disk. Build the game with EMBED_ASSETS defined and the
+// generated file next to embedded_assets.cpp; ResourceManager then finds the files by their path.
+//
+// usage: asset_embedder <output.inc> <file> ...
+//
+// e.g. asset_embedder embedded_assets.inc shaders/sprite.vs shaders/sprite.frag textures/mesa.jpg textures/ball.png textures/paddle.png
+//      asset_embedder embedded_assets.inc assets.pack   (pre-decoded textures, see asset_packer)
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+static int print_usage()
+{
+    std::cout << "usage: asset_embedder <output.inc> <file> ..." << std::endl;
+    return 1;
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 3)
+        return print_usage();
+
+    std::ostringstream out;
+    out << "// generated by asset_embedder, do not edit\n\n";
+
+    // path and size of every embedded file
+    std::vector<std::pair<std::string, std::size_t>> embedded;
+    static const char digits[] = "0123456789abcdef";
+    for (int i = 2; i < argc; i++)
+    {
+        std::ifstream file(argv[i], std::ios::binary);
+        if (!file)
+        {
+            std::cout << "ERROR::ASSET_EMBEDDER: Cannot read " << argv[i] << std::endl;
+            return 1;
+        }
+        const std::vector<unsigned char> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        // the path as the game asks for it, with forward slashes
+        std::string name = argv[i];
+        for (char& c : name)
+            c = c == '\\' ? '/' : c;
+        embedded.emplace_back(name, bytes.size());
+
+        // aligned like asset pack payloads, so embedded packs can be used in place
+        out << "// " << name << "\nalignas(64) static constexpr unsigned char embedded_" << embedded.size() - 1 << "[] = {";
+        std::string line;
+        for (std::size_t b = 0; b < bytes.size(); b++)
+        {
+            if (b % 24 == 0)
+            {
+                out << line << "\n   ";
+                line.clear();
+            }
+            line += " 0x";
+            line += digits[bytes[b] >> 4];
+            line += digits[bytes[b] & 15];
+            line += ',';
+        }
+        // zero-length arrays are not allowed
+        out << line << (bytes.empty() ? "\n    0" : "") << "\n};\n\n";
+        std::cout << "embedded " << name << " (" << bytes.size() << " bytes)" << std::endl;
+    }
+
+    out << "static const EmbeddedAsset embedded_assets[] = {\n";
+    // the sizes are the file sizes, the padding byte of an empty file does not count
+    for (std::size_t i = 0; i < embedded.size(); i++)
+        out << "    { \"" << embedded[i].first << "\", embedded_" << i << ", " << embedded[i].second << " },\n";
+    out << "};\nstatic const std::size_t embedded_asset_count = " << embedded.size() << ";\n";
+
+    // the game build runs this before every compile; an unchanged file keeps embedded_assets.cpp from being rebuilt
+    const std::string generated = out.str();
+    std::ifstream previous(argv[1], std::ios::binary);
+    if (previous && std::string((std::istreambuf_iterator<char>(previous)), std::istreambuf_iterator<char>()) == generated)
+        return 0;
+    previous.close();
+    std::ofstream file(argv[1], std::ios::binary);
+    if (!file.write(generated.data(), static_cast<std::streamsize>(generated.size())))
+    {
+        std::cout << "ERROR::ASSET_EMBEDDER: Cannot write " << argv[1] << std::endl;
+        return 1;
+    }
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,84 @@
+// Offline asset packer: decodes textures and collects shader sources into a single
+// asset pack (see asset_pack.h) that the game memory maps at startup.
+//
+// usage: asset_packer <output.pack> [--mipmaps[=box|kaiser]] [--shader <name> <vertex> <fragment> [geometry]] [--texture <name> <file> rgb|rgba] ...
+//
+// e.g. asset_packer assets.pack --mipmaps --shader sprite shaders/sprite.vs shaders/sprite.frag
+//          --texture background textures/mesa.jpg rgb --texture ball textures/ball.png rgba --texture paddle textures/paddle.png rgba
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#include "asset_pack.h"
+#include "ResourceManager.h"
+
+static int print_usage()
+{
+    std::cout << "usage: asset_packer <output.pack> [--mipmaps[=box|kaiser]] [--shader <name> <vertex> <fragment> [geometry]] [--texture <name> <file> rgb|rgba] ..." << std::endl;
+    return 1;
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 3)
+        return print_usage();
+
+    AssetPackWriter writer;
+    bool mipmaps = false;
+    mip_filter filter = mip_filter_box;
+    for (int i = 2; i < argc; i++)
+    {
+        if (std::strcmp(argv[i], "--mipmaps") == 0 || std::strcmp(argv[i], "--mipmaps=box") == 0)
+        {
+            mipmaps = true;
+        }
+        else if (std::strcmp(argv[i], "--mipmaps=kaiser") == 0)
+        {
+            mipmaps = true;
+            filter = mip_filter_kaiser;
+        }
+        else if (std::strcmp(argv[i], "--shader") == 0 && i + 3 < argc)
+        {
+            const char* name = argv[i + 1];
+            const std::string vertex = ResourceManager::read_text_file(argv[i + 2]);
+            const std::string fragment = ResourceManager::read_text_file(argv[i + 3]);
+            i += 3;
+            // the geometry stage is optional
+            std::string geometry;
+            if (i + 1 < argc && std::strncmp(argv[i + 1], "--", 2) != 0)
+                geometry = ResourceManager::read_text_file(argv[++i]);
+            writer.add_shader(name, vertex, fragment, geometry);
+            std::cout << "shader  " << name << std::endl;
+        }
+        else if (std::strcmp(argv[i], "--texture") == 0 && i + 3 < argc)
+        {
+            const char* name = argv[i + 1];
+            const char* file = argv[i + 2];
+            const bool alpha = std::strcmp(argv[i + 3], "rgba") == 0;
+            i += 3;
+            TextureData data = ResourceManager::decode_texture_from_file(file, alpha);
+            if (data.compressed_format != 0)
+            {
+                std::cout << "ERROR::ASSET_PACKER: " << file << " is block-compressed, packs hold decoded pixels only" << std::endl;
+                ResourceManager::free_texture_data(data);
+                return 1;
+            }
+            if (data.base_level() == nullptr)
+                return 1;
+            if (data.channels != (alpha ? 4 : 3))
+            {
+                std::cout << "ERROR::ASSET_PACKER: " << file << " has " << data.channels << " channels, expected " << (alpha ? 4 : 3) << std::endl;
+                ResourceManager::free_texture_data(data);
+                return 1;
+            }
+            writer.add_texture(name, data, mipmaps, filter);
+            ResourceManager::free_texture_data(data);
+            std::cout << "texture " << name << " (" << data.width << "x" << data.height << ")" << std::endl;
+        }
+        else
+        {
+            return print_usage();
+        }
+    }
+    return writer.write(argv[1]) ? 0 : 1;
+}
\ No newline at end of file
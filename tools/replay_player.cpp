@@ -0,0 +1,74 @@
+// Headless replay player: plays a replay file (recorded with --record) as fast as possible, checks
+// every keyframe against the re-simulated state and reports the step rate, the final score and how
+// long a seek takes. Links only the simulation sources and replay.
+//
+// usage: replay_player <file> [--seek <tick>]
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#include "replay.h"
+#include "simulation.h"
+
+static int print_usage()
+{
+    std::cout << "usage: replay_player <file> [--seek <tick>]" << std::endl;
+    return 1;
+}
+
+int main(int argc, char* argv[])
+{
+    const char* file = nullptr;
+    long long seek_tick = -1;
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::strcmp(argv[i], "--seek") == 0 && i + 1 < argc)
+            seek_tick = std::atoll(argv[++i]);
+        else if (file == nullptr)
+            file = argv[i];
+        else
+            return print_usage();
+    }
+    if (file == nullptr)
+        return print_usage();
+
+    Replay replay;
+    if (!replay.load(file))
+        return 1;
+    std::cout << file << ": ticks " << replay.first_tick() << " to " << replay.end_tick() << ", "
+              << 1.0f / replay.step_length << " Hz" << std::endl;
+
+    Simulation simulation(replay.width, replay.height);
+    if (seek_tick >= 0)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        if (!replay.seek(simulation, static_cast<std::uint64_t>(seek_tick)))
+        {
+            std::cout << "ERROR::REPLAY: tick " << seek_tick << " is not in the recording" << std::endl;
+            return 1;
+        }
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "seek to tick " << seek_tick << " in " << seconds * 1000.0 << " ms, score "
+                  << simulation.player1_score << " - " << simulation.player2_score << std::endl;
+        return 0;
+    }
+
+    // full playback from the first keyframe, every keyframe verified on the way
+    replay.seek(simulation, replay.first_tick());
+    unsigned long long diverged = 0;
+    const auto start = std::chrono::steady_clock::now();
+    while (simulation.tick < replay.end_tick())
+    {
+        simulation.step(replay.input(simulation.tick), replay.step_length);
+        if (!replay.verify(simulation) && diverged++ == 0)
+            std::cout << "ERROR::REPLAY: Playback diverged from the recording at tick " << simulation.tick << std::endl;
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << replay.end_tick() - replay.first_tick() << " ticks in " << seconds << " s: "
+              << (replay.end_tick() - replay.first_tick()) / seconds / 1e6 << " million ticks per second" << std::endl;
+    std::cout << "score: " << simulation.player1_score << " - " << simulation.player2_score << std::endl;
+    std::cout << "state hash: " << std::hex << simulation.state_hash << std::dec << std::endl;
+    return diverged == 0 ? 0 : 1;
+}
\ No newline at end of file
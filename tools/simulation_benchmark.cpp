@@ -0,0 +1,244 @@
+// Headless simulation benchmark: steps the game rules without a window or GL context, both paddles
+// played by AiController at half skill, and reports the step rate. Links only the simulation sources
+// (simulation, batched_simulation, ai_controller, game_object, ball_object, thread_pool).
+//
+// usage: simulation_benchmark [steps] [--batch <matches>] [--threads] [--ai] [--verify]
+//
+// a single match also reports the cost of saving and restoring its SimulationState
+// --batch steps that many matches at once with BatchedSimulation (random inputs), --threads spreads
+// them over the shared thread pool; steps then counts match-steps
+// --ai plays every batched match with the trajectory prediction instead of random inputs
+// --verify checks instead of measuring: the batched kernel against Simulation, bit for bit, for steps
+// per match (300000 by default), and the state hash of a reference match against the known value;
+// exits with 1 on any difference
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#include "ai_controller.h"
+#include "batched_simulation.h"
+#include "simulation.h"
+
+static int print_usage()
+{
+    std::cout << "usage: simulation_benchmark [steps] [--batch <matches>] [--threads] [--ai] [--verify]" << std::endl;
+    return 1;
+}
+
+// state hash after reference_steps of two half-skill bots in a 1370x763 arena; the same on every build and
+// machine. Update it only together with a change to the game rules or the bots.
+constexpr long long     reference_steps = 1000000;
+constexpr std::uint64_t reference_hash = 0x14e44b422f604a2aull;
+
+// the two bots of the reference match
+struct ReferenceBots
+{
+    AiController player1 = AiController(1, ai_settings(0.5f), 1);
+    AiController player2 = AiController(2, ai_settings(0.5f), 2);
+};
+
+// plays the reference match on for steps
+static void play_reference(Simulation& simulation, ReferenceBots& bots, const long long steps)
+{
+    const float dt = 1.0f / simulation_rate;
+    AiController& player1 = bots.player1;
+    AiController& player2 = bots.player2;
+    for (long long i = 0; i < steps; i++)
+    {
+        SimulationInput input;
+        player1.control(simulation, dt, input);
+        player2.control(simulation, dt, input);
+        simulation.step(input, dt);
+    }
+}
+
+static bool same_bits(const float a, const float b)
+{
+    return std::memcmp(&a, &b, sizeof(a)) == 0;
+}
+
+// steps batched matches and one Simulation per match with the same random inputs and compares every field after every step
+static int run_verify(const long long steps)
+{
+    // not a multiple of any SIMD width, so the scalar tail of the last block is covered too
+    constexpr unsigned int matches = 37;
+    const float dt = 1.0f / simulation_rate;
+    // no episode resets, Simulation keeps counting
+    BatchedSimulation batch(matches, 1370, 763, 0xffffffffu);
+    std::vector<Simulation> reference(matches, Simulation(1370, 763));
+    unsigned int seed = 1;
+    unsigned long long mismatches = 0;
+    for (long long i = 0; i < steps; i++)
+    {
+        if (i % 16 == 0)
+        {
+            for (unsigned int m = 0; m < matches; m++)
+            {
+                seed = seed * 1664525u + 1013904223u;
+                batch.inputs[m] = static_cast<unsigned char>(seed >> 27);
+            }
+        }
+        batch.step(dt);
+        for (unsigned int m = 0; m < matches; m++)
+        {
+            Simulation& simulation = reference[m];
+            simulation.step(unpack_input(batch.inputs[m]), dt);
+            const bool same = same_bits(batch.ball_x[m], simulation.ball.position.x) && same_bits(batch.ball_y[m], simulation.ball.position.y) &&
+                              same_bits(batch.ball_velocity_x[m], simulation.ball.velocity.x) && same_bits(batch.ball_velocity_y[m], simulation.ball.velocity.y) &&
+                              same_bits(batch.player1_y[m], simulation.player1.position.y) && same_bits(batch.player2_y[m], simulation.player2.position.y) &&
+                              (batch.stuck[m] != 0.0f) == simulation.ball.stuck &&
+                              batch.player1_score[m] == static_cast<float>(simulation.player1_score) && batch.player2_score[m] == static_cast<float>(simulation.player2_score);
+            if (!same)
+            {
+                if (mismatches == 0)
+                    std::cout << "ERROR::VERIFY: " << BatchedSimulation::kernel_name() << " kernel differs from Simulation in match " << m << " at step " << i + 1 << std::endl;
+                mismatches++;
+                // keep comparing from the same state
+                batch.ball_x[m] = simulation.ball.position.x;
+                batch.ball_y[m] = simulation.ball.position.y;
+                batch.ball_velocity_x[m] = simulation.ball.velocity.x;
+                batch.ball_velocity_y[m] = simulation.ball.velocity.y;
+                batch.player1_y[m] = simulation.player1.position.y;
+                batch.player2_y[m] = simulation.player2.position.y;
+                batch.stuck[m] = simulation.ball.stuck ? 1.0f : 0.0f;
+                batch.player1_score[m] = static_cast<float>(simulation.player1_score);
+                batch.player2_score[m] = static_cast<float>(simulation.player2_score);
+            }
+        }
+    }
+    std::cout << BatchedSimulation::kernel_name() << " kernel, " << matches << " matches x " << steps << " steps: " << mismatches << " mismatches" << std::endl;
+
+    // the reference match, and the same match restored from a snapshot halfway, must both end on the known hash
+    Simulation simulation(1370, 763);
+    ReferenceBots bots;
+    play_reference(simulation, bots, reference_steps / 2);
+    const SimulationState halfway = simulation.save();
+    const ReferenceBots halfway_bots = bots;
+    play_reference(simulation, bots, reference_steps - reference_steps / 2);
+    const std::uint64_t hash = simulation.state_hash;
+    simulation.restore(halfway);
+    bots = halfway_bots;
+    play_reference(simulation, bots, reference_steps - reference_steps / 2);
+    std::cout << "state hash " << std::hex << hash << ", expected " << reference_hash << std::dec << std::endl;
+    const bool hash_ok = hash == reference_hash && simulation.state_hash == hash;
+    if (simulation.state_hash != hash)
+        std::cout << "ERROR::VERIFY: Restoring a snapshot and stepping again ended on another state" << std::endl;
+    else if (hash != reference_hash)
+        std::cout << "ERROR::VERIFY: The simulation is not deterministic on this build, or the rules changed without updating reference_hash" << std::endl;
+    return mismatches == 0 && hash_ok ? 0 : 1;
+}
+
+// inputs of both paddles of every batched match from predict_crossing, with an aim error per match redrawn every few steps
+static void predict_inputs(BatchedSimulation& batch, std::vector<float>& aim_error, unsigned int& seed, const bool new_errors)
+{
+    const float diameter = ball_radius * 2.0f;
+    const float low = 0.0f, high = batch.height - diameter;
+    const float tolerance = player_velocity / simulation_rate;
+    for (unsigned int m = 0; m < batch.count(); m++)
+    {
+        if (new_errors)
+        {
+            seed = seed * 1664525u + 1013904223u;
+            aim_error[m] = (static_cast<float>(seed >> 8) / 16777216.0f - 0.5f) * 160.0f;
+        }
+        // the paddle the ball moves towards heads for the crossing, the other one for the middle
+        const glm::vec2 position(batch.ball_x[m], batch.ball_y[m]), velocity(batch.ball_velocity_x[m], batch.ball_velocity_y[m]);
+        const bool to_player2 = velocity.x > 0.0f;
+        const float plane_x = to_player2 ? batch.width - player_size.x - diameter : player_size.x;
+        const float crossing = predict_crossing(position, velocity, plane_x, low, high) + ball_radius + aim_error[m];
+        const float target1 = to_player2 ? batch.height / 2.0f : crossing;
+        const float target2 = to_player2 ? crossing : batch.height / 2.0f;
+        const float center1 = batch.player1_y[m] + player_size.y / 2.0f, center2 = batch.player2_y[m] + player_size.y / 2.0f;
+        batch.inputs[m] = static_cast<unsigned char>((center1 > target1 + tolerance ? input_player1_up : 0) | (center1 < target1 - tolerance ? input_player1_down : 0) |
+                                                     (center2 > target2 + tolerance ? input_player2_up : 0) | (center2 < target2 - tolerance ? input_player2_down : 0) |
+                                                     input_launch);
+    }
+}
+
+// steps a batch of matches with inputs that change every few steps, or with the prediction bot
+static int run_batch(const long long steps, const unsigned int matches, const bool threads, const bool ai)
+{
+    BatchedSimulation batch(matches, 1370, 763);
+    const long long batch_steps = steps / matches > 0 ? steps / matches : 1;
+    const float dt = 1.0f / simulation_rate;
+    unsigned int seed = 1;
+    unsigned long long points = 0;
+    std::vector<float> aim_error(batch.count());
+    const auto start = std::chrono::steady_clock::now();
+    for (long long i = 0; i < batch_steps; i++)
+    {
+        if (ai)
+            predict_inputs(batch, aim_error, seed, i % 256 == 0);
+        else if (i % 16 == 0)
+        {
+            for (unsigned int m = 0; m < matches; m++)
+            {
+                seed = seed * 1664525u + 1013904223u;
+                batch.inputs[m] = static_cast<unsigned char>(seed >> 27);
+            }
+        }
+        batch.step(dt, threads ? &ThreadPool::shared() : nullptr);
+        points += batch.reward[0] != 0.0f;
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << BatchedSimulation::kernel_name() << " kernel, " << (ai ? "prediction bots, " : "") << matches << " matches x " << batch_steps << " steps in " << seconds << " s: "
+              << batch_steps * matches / seconds / 1e6 << " million match-steps per second" << std::endl;
+    std::cout << "points in match 0: " << points << std::endl;
+    return 0;
+}
+
+int main(int argc, char* argv[])
+{
+    long long steps = 100000000LL;
+    unsigned int matches = 0;
+    bool threads = false;
+    bool ai = false;
+    bool verify = false;
+    bool steps_given = false;
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::strcmp(argv[i], "--batch") == 0 && i + 1 < argc)
+            matches = static_cast<unsigned int>(std::atoi(argv[++i]));
+        else if (std::strcmp(argv[i], "--threads") == 0)
+            threads = true;
+        else if (std::strcmp(argv[i], "--ai") == 0)
+            ai = true;
+        else if (std::strcmp(argv[i], "--verify") == 0)
+            verify = true;
+        else if ((steps = std::atoll(argv[i])) <= 0)
+            return print_usage();
+        else
+            steps_given = true;
+    }
+    if (verify)
+        return run_verify(steps_given ? steps : 300000);
+    if (matches > 0)
+        return run_batch(steps, matches, threads, ai);
+
+    Simulation simulation(1370, 763);
+    ReferenceBots bots;
+    const auto start = std::chrono::steady_clock::now();
+    play_reference(simulation, bots, steps);
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << steps << " steps (" << steps / simulation_rate / 3600.0 << " hours of play) in " << seconds << " s: "
+              << steps / seconds / 1e6 << " million steps per second" << std::endl;
+    std::cout << "score " << simulation.player1_score << " - " << simulation.player2_score << std::endl;
+    // identical for every build and machine; a different value means the simulation is not deterministic there
+    std::cout << "state hash " << std::hex << simulation.state_hash << std::dec << std::endl;
+
+    // cost of a snapshot round trip, as rollback pays it every tick
+    const long long snapshots = 10000000LL;
+    SimulationState state = simulation.save();
+    const auto snapshot_start = std::chrono::steady_clock::now();
+    for (long long i = 0; i < snapshots; i++)
+    {
+        simulation.restore(state);
+        state = simulation.save();
+    }
+    const double snapshot_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - snapshot_start).count();
+    std::cout << "save + restore: " << snapshot_seconds / snapshots * 1e9 << " ns (" << sizeof(SimulationState) << " bytes)" << std::endl;
+    return 0;
+}
\ No newline at end of file
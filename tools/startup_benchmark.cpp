@@ -0,0 +1,146 @@
+// Time-to-first-frame benchmark: launches the game repeatedly with --startup-benchmark, which makes it
+// quit after its first complete frame and write startup_timeline.json, and reports percentiles of every
+// startup phase. Run it from the game's directory (the game loads its assets relative to it).
+//
+// usage: startup_benchmark <game executable> [runs] [--fail-above <ms>]
+//
+// e.g. startup_benchmark "x64/Release/Ping Pong.exe" 20 --fail-above 500
+//      fails (exit code 2) when the p90 time to the first complete frame is above 500 ms
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+static const char* const timeline_file = "startup_timeline.json";
+
+static int print_usage()
+{
+    std::cout << "usage: startup_benchmark <game executable> [runs] [--fail-above <ms>]" << std::endl;
+    return 1;
+}
+
+// a phase of one run: its name, its duration and when it ended, in milliseconds
+struct RunPhase
+{
+    std::string name;
+    double      ms;
+    double      at_ms;
+};
+
+// number following "key": on the line, or -1 when missing
+static double json_number(const std::string& line, const char* key)
+{
+    const std::string quoted = std::string("\"") + key + "\":";
+    const std::size_t at = line.find(quoted);
+    return at == std::string::npos ? -1.0 : std::atof(line.c_str() + at + quoted.size());
+}
+
+// reads the phases written by StartupTimeline::write_json, one per line
+static bool read_timeline(std::vector<RunPhase>& phases)
+{
+    std::ifstream in(timeline_file);
+    if (!in)
+        return false;
+    std::string line;
+    while (std::getline(in, line))
+    {
+        const std::size_t name = line.find("\"name\": \"");
+        if (name == std::string::npos)
+            continue;
+        const std::size_t begin = name + std::strlen("\"name\": \"");
+        const std::size_t end = line.find('"', begin);
+        phases.push_back({ line.substr(begin, end - begin), json_number(line, "ms"), json_number(line, "at_ms") });
+    }
+    return !phases.empty();
+}
+
+// nearest-rank percentile of sorted samples
+static double percentile(const std::vector<double>& sorted, double p)
+{
+    const std::size_t rank = static_cast<std::size_t>(p / 100.0 * sorted.size() + 0.999999);
+    return sorted[std::min(sorted.size(), std::max<std::size_t>(rank, 1)) - 1];
+}
+
+static void print_row(const std::string& name, std::vector<double> samples)
+{
+    std::sort(samples.begin(), samples.end());
+    std::cout << "  " << std::left << std::setw(24) << name << std::right
+              << std::setw(10) << percentile(samples, 50.0) << std::setw(10) << percentile(samples, 90.0) << std::setw(10) << percentile(samples, 99.0)
+              << std::setw(10) << samples.front() << std::setw(10) << samples.back() << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2)
+        return print_usage();
+    int runs = 10;
+    double failAbove = -1.0;
+    for (int i = 2; i < argc; i++)
+    {
+        if (std::strcmp(argv[i], "--fail-above") == 0 && i + 1 < argc)
+            failAbove = std::atof(argv[++i]);
+        else if ((runs = std::atoi(argv[i])) <= 0)
+            return print_usage();
+    }
+
+    const std::string command = std::string("\"") + argv[1] + "\" --startup-benchmark";
+    // per phase name, in first-seen order: the durations of every run
+    std::vector<std::pair<std::string, std::vector<double>>> durations;
+    std::vector<double> firstFrame, completeFrame;
+    for (int run = 0; run < runs; run++)
+    {
+        std::remove(timeline_file);
+        if (std::system(command.c_str()) != 0)
+        {
+            std::cout << "ERROR::STARTUP_BENCHMARK: Run " << run + 1 << " of " << argv[1] << " failed" << std::endl;
+            return 1;
+        }
+        std::vector<RunPhase> phases;
+        if (!read_timeline(phases))
+        {
+            std::cout << "ERROR::STARTUP_BENCHMARK: Run " << run + 1 << " wrote no " << timeline_file << std::endl;
+            return 1;
+        }
+        for (const RunPhase& phase : phases)
+        {
+            auto iter = std::find_if(durations.begin(), durations.end(), [&](const std::pair<std::string, std::vector<double>>& entry) { return entry.first == phase.name; });
+            if (iter == durations.end())
+                iter = durations.insert(durations.end(), { phase.name, {} });
+            iter->second.push_back(phase.ms);
+            if (phase.name == "first frame")
+                firstFrame.push_back(phase.at_ms);
+            else if (phase.name == "first complete frame")
+                completeFrame.push_back(phase.at_ms);
+        }
+    }
+    std::remove(timeline_file);
+
+    std::cout << std::fixed << std::setprecision(2) << runs << " runs, milliseconds\n"
+              << "  " << std::left << std::setw(24) << "phase" << std::right
+              << std::setw(10) << "p50" << std::setw(10) << "p90" << std::setw(10) << "p99" << std::setw(10) << "min" << std::setw(10) << "max" << std::endl;
+    for (const auto& phase : durations)
+        print_row(phase.first, phase.second);
+    if (!firstFrame.empty())
+        print_row("time to first frame", firstFrame);
+    if (completeFrame.empty())
+    {
+        std::cout << "ERROR::STARTUP_BENCHMARK: No run reached a complete frame" << std::endl;
+        return 1;
+    }
+    print_row("time to complete frame", completeFrame);
+
+    // regression gate on the p90 rather than a single noisy run
+    std::sort(completeFrame.begin(), completeFrame.end());
+    if (failAbove >= 0.0 && percentile(completeFrame, 90.0) > failAbove)
+    {
+        std::cout << "FAILED: p90 time to complete frame " << percentile(completeFrame, 90.0) << " ms is above " << failAbove << " ms" << std::endl;
+        return 2;
+    }
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,82 @@
+// Offline texture compressor: converts PNG/JPEG sources into block-compressed
+// DDS files (BC1 for opaque images, BC3 for images with alpha) that
+// ResourceManager::load_texture uploads without decoding.
+//
+// usage: texture_compressor <input> <output.dds> [bc1|bc3] [--mipmaps[=box|kaiser]]
+//
+// e.g. texture_compressor textures/mesa.jpg textures/mesa.dds --mipmaps=kaiser
+#include <cstring>
+#include <iostream>
+
+#include "bc_encoder.h"
+#include "compressed_texture.h"
+#include "mipmap.h"
+#include "ResourceManager.h"
+
+static int print_usage()
+{
+    std::cout << "usage: texture_compressor <input> <output.dds> [bc1|bc3] [--mipmaps[=box|kaiser]]" << std::endl;
+    return 1;
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 3)
+        return print_usage();
+
+    unsigned int format = 0;
+    TextureSettings settings;
+    for (int i = 3; i < argc; i++)
+    {
+        if (std::strcmp(argv[i], "bc1") == 0)
+            format = compressed_bc1_rgb;
+        else if (std::strcmp(argv[i], "bc3") == 0)
+            format = compressed_bc3;
+        else if (std::strcmp(argv[i], "--mipmaps") == 0 || std::strcmp(argv[i], "--mipmaps=box") == 0)
+            settings.mipmaps = mipmaps_box;
+        else if (std::strcmp(argv[i], "--mipmaps=kaiser") == 0)
+            settings.mipmaps = mipmaps_kaiser;
+        else
+            return print_usage();
+    }
+
+    // decode (and build the mip chain) with the same code the game uses
+    TextureData data = ResourceManager::decode_texture_from_file(argv[1], format == compressed_bc3, settings);
+    if (data.compressed_format != 0 || data.base_level() == nullptr)
+    {
+        std::cout << "ERROR::TEXTURE_COMPRESSOR: " << argv[1] << " is not a PNG/JPEG source image" << std::endl;
+        ResourceManager::free_texture_data(data);
+        return 1;
+    }
+    if (data.channels < 3)
+    {
+        std::cout << "ERROR::TEXTURE_COMPRESSOR: " << argv[1] << " has " << data.channels << " channels, expected RGB or RGBA" << std::endl;
+        ResourceManager::free_texture_data(data);
+        return 1;
+    }
+    if (format == 0)
+        format = data.channels == 4 ? compressed_bc3 : compressed_bc1_rgb;
+
+    CompressedImage image;
+    image.format = format;
+    image.width = data.width;
+    image.height = data.height;
+    image.mip_levels = data.mip_levels;
+    const unsigned char* level = data.base_level();
+    unsigned int width = data.width, height = data.height;
+    for (unsigned int i = 0; i < data.mip_levels; i++)
+    {
+        const std::vector<unsigned char> blocks = compress_image(level, width, height, data.channels, format);
+        image.data.insert(image.data.end(), blocks.begin(), blocks.end());
+        level += static_cast<std::size_t>(width) * height * data.channels;
+        width = width > 1 ? width / 2 : 1;
+        height = height > 1 ? height / 2 : 1;
+    }
+    ResourceManager::free_texture_data(data);
+
+    if (!save_dds(argv[2], image))
+        return 1;
+    std::cout << argv[2] << ": " << (format == compressed_bc3 ? "BC3" : "BC1") << " " << image.width << "x" << image.height << ", "
+        << image.mip_levels << " level(s), " << image.data.size() << " bytes" << std::endl;
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,142 @@
+#include "udp_socket.h"
+
+#include <cstring>
+#include <iostream>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+// Winsock is started once for the process and left to its exit to clean up
+static bool start_winsock()
+{
+    static const bool started = [] { WSADATA wsa; return WSAStartup(MAKEWORD(2, 2), &wsa) == 0; }();
+    return started;
+}
+#endif
+
+
+UdpSocket::UdpSocket()
+    : socket_(-1), peer_address_(0), peer_port_(0) { }
+
+UdpSocket::~UdpSocket()
+{
+    this->close();
+}
+
+bool UdpSocket::open(const unsigned short local_port, const char* peer_host, const unsigned short peer_port)
+{
+    this->close();
+#ifdef _WIN32
+    if (!start_winsock())
+    {
+        std::cout << "ERROR::SOCKET: Winsock is not available" << std::endl;
+        return false;
+    }
+#endif
+    // resolve the peer first, a wrong host name should not leave a bound socket behind
+    addrinfo hints;
+    std::memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_DGRAM;
+    addrinfo* peer = nullptr;
+    if (getaddrinfo(peer_host, nullptr, &hints, &peer) != 0 || peer == nullptr)
+    {
+        std::cout << "ERROR::SOCKET: Failed to resolve " << peer_host << std::endl;
+        return false;
+    }
+    this->peer_address_ = reinterpret_cast<const sockaddr_in*>(peer->ai_addr)->sin_addr.s_addr;
+    this->peer_port_ = htons(peer_port);
+    freeaddrinfo(peer);
+
+    this->socket_ = static_cast<std::intptr_t>(socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP));
+    sockaddr_in local;
+    std::memset(&local, 0, sizeof(local));
+    local.sin_family = AF_INET;
+    local.sin_addr.s_addr = htonl(INADDR_ANY);
+    local.sin_port = htons(local_port);
+#ifdef _WIN32
+    u_long non_blocking = 1;
+    const bool ready = this->socket_ != -1 &&
+                       bind(static_cast<SOCKET>(this->socket_), reinterpret_cast<const sockaddr*>(&local), sizeof(local)) == 0 &&
+                       ioctlsocket(static_cast<SOCKET>(this->socket_), FIONBIO, &non_blocking) == 0;
+#else
+    const bool ready = this->socket_ != -1 &&
+                       bind(static_cast<int>(this->socket_), reinterpret_cast<const sockaddr*>(&local), sizeof(local)) == 0 &&
+                       fcntl(static_cast<int>(this->socket_), F_SETFL, fcntl(static_cast<int>(this->socket_), F_GETFL, 0) | O_NONBLOCK) == 0;
+#endif
+    if (!ready)
+    {
+        std::cout << "ERROR::SOCKET: Failed to bind UDP port " << local_port << std::endl;
+        this->close();
+        return false;
+    }
+    return true;
+}
+
+void UdpSocket::close()
+{
+    // INVALID_SOCKET is -1 as well
+    if (this->socket_ == -1)
+        return;
+#ifdef _WIN32
+    closesocket(static_cast<SOCKET>(this->socket_));
+#else
+    ::close(static_cast<int>(this->socket_));
+#endif
+    this->socket_ = -1;
+}
+
+bool UdpSocket::is_open() const
+{
+    return this->socket_ != -1;
+}
+
+bool UdpSocket::send(const void* data, const std::size_t size)
+{
+    if (!this->is_open())
+        return false;
+    sockaddr_in peer;
+    std::memset(&peer, 0, sizeof(peer));
+    peer.sin_family = AF_INET;
+    peer.sin_addr.s_addr = this->peer_address_;
+    peer.sin_port = this->peer_port_;
+#ifdef _WIN32
+    return sendto(static_cast<SOCKET>(this->socket_), static_cast<const char*>(data), static_cast<int>(size), 0,
+                  reinterpret_cast<const sockaddr*>(&peer), sizeof(peer)) == static_cast<int>(size);
+#else
+    return sendto(static_cast<int>(this->socket_), data, size, 0, reinterpret_cast<const sockaddr*>(&peer), sizeof(peer)) == static_cast<ssize_t>(size);
+#endif
+}
+
+std::size_t UdpSocket::receive(void* buffer, const std::size_t size)
+{
+    while (this->is_open())
+    {
+        sockaddr_in sender;
+        socklen_t sender_size = sizeof(sender);
+#ifdef _WIN32
+        const int received = recvfrom(static_cast<SOCKET>(this->socket_), static_cast<char*>(buffer), static_cast<int>(size), 0,
+                                      reinterpret_cast<sockaddr*>(&sender), &sender_size);
+#else
+        const ssize_t received = recvfrom(static_cast<int>(this->socket_), buffer, size, 0, reinterpret_cast<sockaddr*>(&sender), &sender_size);
+#endif
+        // nothing waiting (or an error, which UDP has no use for)
+        if (received <= 0)
+            return 0;
+        if (sender.sin_addr.s_addr == this->peer_address_ && sender.sin_port == this->peer_port_)
+            return static_cast<std::size_t>(received);
+    }
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,32 @@
+#ifndef UDP_SOCKET_H
+#define UDP_SOCKET_H
+
+#include <cstddef>
+#include <cstdint>
+
+
+// Non-blocking UDP socket that talks to a single peer (Winsock on Windows, BSD sockets elsewhere).
+// Datagrams from any other address are dropped.
+class UdpSocket
+{
+public:
+    UdpSocket();
+    ~UdpSocket();
+    UdpSocket(const UdpSocket&) = delete;
+    UdpSocket& operator=(const UdpSocket&) = delete;
+
+    // binds local_port and addresses peer_host:peer_port from then on; returns false if either fails
+    bool        open(unsigned short local_port, const char* peer_host, unsigned short peer_port);
+    void        close();
+    bool        is_open() const;
+    // sends one datagram to the peer
+    bool        send(const void* data, std::size_t size);
+    // takes one waiting datagram from the peer; returns its size, or 0 when none is waiting
+    std::size_t receive(void* buffer, std::size_t size);
+private:
+    std::intptr_t socket_;       // SOCKET or file descriptor, -1 when closed
+    std::uint32_t peer_address_; // network byte order
+    std::uint16_t peer_port_;
+};
+
+#endif
\ No newline at end of file